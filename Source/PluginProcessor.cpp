@@ -30,6 +30,7 @@ EqualizerAudioProcessor::EqualizerAudioProcessor()
 
 EqualizerAudioProcessor::~EqualizerAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -67,7 +68,7 @@ bool EqualizerAudioProcessor::isMidiEffect() const
 
 double EqualizerAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int EqualizerAudioProcessor::getNumPrograms()
@@ -100,18 +101,29 @@ void EqualizerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = (uint32_t) samplesPerBlock;
-    spec.numChannels = 1;
 
-    leftChain.prepare (spec);
-    rightChain.prepare (spec);
+    auto layout = getChannelLayoutOfBus (false, 0);
+    channelTypes = ChannelGroups::getChannelTypes (layout);
+    numChannels = static_cast<size_t> (juce::jlimit (1, static_cast<int> (ChannelGroups::MAX_CHANNELS), layout.size()));
+    updateChannelGroups (getEqMode());
 
-    spec.numChannels = 2;
-    inputGain.prepare (spec);
-    outputGain.prepare (spec);
+    spec.numChannels = static_cast<uint32_t> (numChannels);
+    prepareProcessingPath (floatPath, spec);
+    prepareProcessingPath (doublePath, spec);
+    linearPhaseEngine.prepare (spec);
 
     initializeOrder();
 
-    ChainHelpers::initializeChains (leftChain, rightChain, sampleRate, apvts);
+    ChainHelpers::initializeChains (leftChain, rightChain, sampleRate, parameterTable);
+    parameterTable.markEverythingChanged();
+
+    // the FIR length depends on the sample rate
+    latencyEngine = getFilterEngine();
+    setLatencySamples (getLatencyInSamples (latencyEngine));
+
+    silenceDetector.reset();
+    updateTailLength (latencyEngine, true);
+    linearPhaseDesignPending = true;
 
 #ifdef USE_TEST_SIGNAL
     testOscillator.prepare (spec);
@@ -121,6 +133,18 @@ void EqualizerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     sampleRateListeners.call ([sampleRate] (SampleRateListener& l) { l.sampleRateChanged (sampleRate); });
 }
 
+template <typename SampleType>
+void EqualizerAudioProcessor::prepareProcessingPath (ProcessingPath<SampleType>& path, const juce::dsp::ProcessSpec& spec)
+{
+    path.inputGain.prepare (spec);
+    path.outputGain.prepare (spec);
+    path.laneChains.prepare (static_cast<int> (spec.maximumBlockSize));
+    for (auto& svfChain : path.svfChains)
+    {
+        svfChain.prepare (spec.sampleRate, RAMP_TIME_IN_SECONDS);
+    }
+}
+
 void EqualizerAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
@@ -134,15 +158,10 @@ bool EqualizerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
 #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    //if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-    //    && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-    // NOTE: For some reason, the above code does not work with the AU plugin in Logic Pro and validation crashes.
-    // Somehow, it expects the plugin to be only stereo. So, we will only support stereo for now.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // any channel set up to ChannelGroups::MAX_CHANNELS channels: mono, stereo, surround and immersive beds
+    // or discrete channels. the bus stays stereo by default, which is what Logic Pro expects.
+    auto numOutputChannels = layouts.getMainOutputChannelSet().size();
+    if (layouts.getMainOutputChannelSet().isDisabled() || numOutputChannels > static_cast<int> (ChannelGroups::MAX_CHANNELS))
         return false;
 
         // This checks if the input layout matches the output layout
@@ -156,7 +175,23 @@ bool EqualizerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 }
 #endif
 
-void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+bool EqualizerAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples (buffer);
+}
+
+void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples (buffer);
+}
+
+template <typename SampleType>
+void EqualizerAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
@@ -165,13 +200,53 @@ void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateTrimGains();
+    auto& path = getProcessingPath<SampleType>();
+    updateTrimGains (path);
 
     auto mode = getEqMode();
-    updateParameters (mode);
+    auto changes = parameterTable.consumeChanges();
+    if ((changes & ParameterTable::CHANNEL_GROUPS) != 0)
+    {
+        updateChannelGroups (mode);
+    }
+    updateParameters (mode, changes);
+
+    // before the active bands: ending the ramps may make a band inactive
+    auto engine = getFilterEngine();
+    updateEngine (engine);
+    auto activityChanged = updateActiveBands();
+
+    auto block = juce::dsp::AudioBlock<SampleType> (buffer).getSubsetChannelBlock (
+        0,
+        juce::jmin (numChannels, static_cast<size_t> (buffer.getNumChannels())));
+
+    // every bit, bands or channel groups, may change what the chains head to
+    auto targetsChanged = changes != 0 || activityChanged;
+    updateTailLength (engine, targetsChanged);
+    linearPhaseDesignPending |= targetsChanged;
+    if (engine == FilterEngine::LINEAR_PHASE && linearPhaseDesignPending)
+    {
+        // the FIRs follow the target parameters, the convolution crossfades between them instead of smoothing
+        linearPhaseDesignPending = ! linearPhaseEngine.update (leftChain, rightChain, channelGroups);
+    }
+
+#if ! USE_TEST_SIGNAL
+    /*
+     a sleeping instance stays asleep as long as its input is digital silence:
+     nothing is filtered and the output is the input, zeros.
+     the meters show silence and the analyzer isn't fed.
+     */
+    if (silenceDetector.shouldSkip (block))
+    {
+        path.inputMeter.reset();
+        path.outputMeter.reset();
+        inMeterValuesFifo.push (path.inputMeter.getMeterValues());
+        outMeterValuesFifo.push (path.outputMeter.getMeterValues());
+        return;
+    }
+#endif
 
-    auto block = juce::dsp::AudioBlock<float> (buffer);
-    inputGain.process (juce::dsp::ProcessContextReplacing<float> (block));
+    unsigned enabledStages = 0;
 
 #if USE_TEST_SIGNAL
     auto fftOrder = getCurrentFFTOrder();
@@ -193,64 +268,206 @@ void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
         }
     }
 
-    testGain.process (juce::dsp::ProcessContextReplacing<float> (block));
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        testGain.process (juce::dsp::ProcessContextReplacing<float> (block));
+    }
+#else
+    // the test signal replaces the input, trimmed or not
+    if (FusedBlockPipeline::isGainStageNeeded (path.inputGain))
+    {
+        enabledStages |= FusedBlockPipeline::INPUT_GAIN;
+    }
 #endif
 
-    updateMeterFifos (inMeterValuesFifo, buffer);
+    if (FusedBlockPipeline::isGainStageNeeded (path.outputGain))
+    {
+        enabledStages |= FusedBlockPipeline::OUTPUT_GAIN;
+    }
 
-    auto processingModeName = AnalyzerProperties::GetAnalyzerParams().at (AnalyzerProperties::ParamNames::AnalyzerProcessingMode);
-    auto processingMode = static_cast<AnalyzerProperties::ProcessingModes> (getRawParameter (processingModeName));
+    if (parameterTable.isAnalyzerEnabled())
+    {
+        auto processingMode = parameterTable.getAnalyzerProcessingMode();
+        enabledStages |= processingMode == AnalyzerProperties::ProcessingModes::Pre ? FusedBlockPipeline::PRE_FILTER_TAP
+                                                                                     : FusedBlockPipeline::POST_FILTER_TAP;
+    }
+
+    auto midSide = mode == EqMode::MID_SIDE && block.getNumChannels() >= 2;
 
-    auto enabledName = AnalyzerProperties::GetAnalyzerParams().at (AnalyzerProperties::ParamNames::EnableAnalyzer);
-    auto analyzerEnabled = getRawParameter (enabledName) > 0.5;
+    auto useParallelForm = engine == FilterEngine::PARALLEL;
+    auto interpolate = ! useParallelForm && isCoefficientInterpolationEnabled();
 
-    if (analyzerEnabled && processingMode == AnalyzerProperties::ProcessingModes::Pre)
+    auto filter = [this, engine, midSide, useParallelForm, interpolate] (juce::dsp::AudioBlock<SampleType>& chunk)
     {
-        spectrumAnalyzerFifoLeft.update (buffer);
-        spectrumAnalyzerFifoRight.update (buffer);
-    }
+        if (engine == FilterEngine::SVF)
+        {
+            processSvfEngine (chunk, midSide);
+        }
+        else if (engine == FilterEngine::LINEAR_PHASE)
+        {
+            processLinearPhaseEngine (chunk, midSide);
+        }
+        else
+        {
+            processBiquadEngine (chunk, useParallelForm, interpolate, midSide);
+        }
+    };
 
-    if (mode == EqMode::MID_SIDE)
+    auto analyzerTap = [this] (const juce::dsp::AudioBlock<SampleType>& chunk)
     {
-        midSideProcessor.process (juce::dsp::ProcessContextReplacing<float> (block));
+        spectrumAnalyzerFifoLeft.update (chunk);
+        spectrumAnalyzerFifoRight.update (chunk);
+    };
+
+    FusedBlockPipeline::Stages<SampleType> stages { path.inputGain, path.outputGain, path.inputMeter, path.outputMeter };
+    FusedBlockPipeline::dispatch (enabledStages, block, stages, filter, analyzerTap, analyzerTap);
+
+    inMeterValuesFifo.push (path.inputMeter.getMeterValues());
+    outMeterValuesFifo.push (path.outputMeter.getMeterValues());
+
+#if ! USE_TEST_SIGNAL
+    if (silenceDetector.update (block, juce::jmax (tailLengthInSamples, static_cast<juce::int64> (getLatencySamples()))))
+    {
+        // what's left in the filters is below the floor, the instance wakes up from a clean state
+        path.laneChains.reset();
+        for (auto& svfChain : path.svfChains)
+        {
+            svfChain.reset();
+        }
+        linearPhaseEngine.reset();
     }
+#endif
 
-    const size_t SUB_BLOCK_MAX_SIZE = 32;
+#ifdef USE_TEST_SIGNAL
+    buffer.clear();
+#endif
+}
+
+template <typename SampleType>
+void EqualizerAudioProcessor::processBiquadEngine (juce::dsp::AudioBlock<SampleType>& block,
+                                                   bool useParallelForm,
+                                                   bool interpolate,
+                                                   bool midSide)
+{
+    /*
+     the chunk is only split while some band is ramping: the sub-block size is
+     the control rate of the smoothers. In steady state it goes through in one go.
+     with coefficient interpolation the coefficients ramp across every sub-block,
+     from the values at its start to the ones at its end, so a coarser control
+     rate doesn't produce audible steps.
+     the parallel engine converts the cascade into parallel sections whenever the
+     coefficients change, their coefficients don't ramp.
+     */
+    auto subBlockMaxSize = interpolate ? INTERPOLATED_SMOOTHING_SUB_BLOCK_SIZE : smoothingSubBlockSize.load();
     for (size_t offset = 0; offset < block.getNumSamples();)
     {
         auto numSamplesLeft = block.getNumSamples() - offset;
-        auto maxChunkSize = juce::jmin (numSamplesLeft, SUB_BLOCK_MAX_SIZE);
+        auto maxChunkSize = isAnyActiveBandSmoothing() ? juce::jmin (numSamplesLeft, subBlockMaxSize) : numSamplesLeft;
         auto subBlock = block.getSubBlock (offset, maxChunkSize);
 
-        auto leftBlock = subBlock.getSingleChannelBlock (static_cast<size_t> (Channel::LEFT));
-        auto rightBlock = subBlock.getSingleChannelBlock (static_cast<size_t> (Channel::RIGHT));
+        updateFilters (static_cast<int> (maxChunkSize), interpolate);
 
-        updateFilters (static_cast<int> (maxChunkSize));
+        typename MultichannelChain<SampleType>::Chains chains {};
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            chains[channel] = &getChain (channelGroups[channel]);
+        }
 
-        leftChain.process (juce::dsp::ProcessContextReplacing<float> (leftBlock));
-        rightChain.process (juce::dsp::ProcessContextReplacing<float> (rightBlock));
+        auto& laneChains = getProcessingPath<SampleType>().laneChains;
+        laneChains.setParallelFormEnabled (useParallelForm);
+        laneChains.update (chains, block.getNumChannels(), interpolate ? maxChunkSize : 0);
+        processWithMidSide (subBlock, midSide, [&laneChains] (auto& chunk) { laneChains.process (chunk); });
 
         offset += maxChunkSize;
     }
+}
+
+template <typename SampleType>
+void EqualizerAudioProcessor::processSvfEngine (juce::dsp::AudioBlock<SampleType>& block, bool midSide)
+{
+    // the SVF sections smooth their coefficients per sample, so the whole block goes through in one go
+    auto& path = getProcessingPath<SampleType>();
+    processWithMidSide (block,
+                        midSide,
+                        [&path] (auto& chunk)
+                        {
+                            auto numSamples = static_cast<int> (chunk.getNumSamples());
+                            for (size_t channel = 0; channel < chunk.getNumChannels(); ++channel)
+                            {
+                                path.svfChains[channel].process (chunk.getChannelPointer (channel), numSamples);
+                            }
+                        });
+}
+
+template <typename SampleType>
+void EqualizerAudioProcessor::processLinearPhaseEngine (juce::dsp::AudioBlock<SampleType>& block, bool midSide)
+{
+    processWithMidSide (block, midSide, [this] (auto& chunk) { linearPhaseEngine.process (chunk); });
+}
+
+void EqualizerAudioProcessor::updateEngine (FilterEngine engine)
+{
+    if (engine == latencyEngine)
+    {
+        return;
+    }
 
-    if (mode == EqMode::MID_SIDE)
+    // the svf and linear phase engines don't advance the smoothers of the links
+    skipSmoothing<ChainPositions::LOWCUT>();
+    skipSmoothing<ChainPositions::LOWSHELF>();
+    skipSmoothing<ChainPositions::PEAK1>();
+    skipSmoothing<ChainPositions::PEAK2>();
+    skipSmoothing<ChainPositions::PEAK3>();
+    skipSmoothing<ChainPositions::PEAK4>();
+    skipSmoothing<ChainPositions::HIGHSHELF>();
+    skipSmoothing<ChainPositions::HIGHCUT>();
+
+    if (engine == FilterEngine::LINEAR_PHASE)
     {
-        midSideProcessor.process (juce::dsp::ProcessContextReplacing<float> (block));
+        // whatever is left in the convolution is from the last time the engine was used
+        linearPhaseEngine.reset();
     }
 
-    if (analyzerEnabled && processingMode == AnalyzerProperties::ProcessingModes::Post)
+    latencyEngine = engine;
+    triggerAsyncUpdate();
+}
+
+int EqualizerAudioProcessor::getLatencyInSamples (FilterEngine engine)
+{
+    return engine == FilterEngine::LINEAR_PHASE ? linearPhaseEngine.getLatencyInSamples() : 0;
+}
+
+void EqualizerAudioProcessor::handleAsyncUpdate()
+{
+    // the audio thread switches to the engine of the parameter on its next block
+    setLatencySamples (getLatencyInSamples (getFilterEngine()));
+}
+
+void EqualizerAudioProcessor::updateTailLength (FilterEngine engine, bool targetsChanged)
+{
+    if (engine == tailEngine && ! targetsChanged)
     {
-        spectrumAnalyzerFifoLeft.update (buffer);
-        spectrumAnalyzerFifoRight.update (buffer);
+        return;
     }
 
-    outputGain.process (juce::dsp::ProcessContextReplacing<float> (block));
+    tailEngine = engine;
 
-    updateMeterFifos (outMeterValuesFifo, buffer);
+    // the FIRs ring for their whole length, the latency included
+    if (engine == FilterEngine::LINEAR_PHASE)
+    {
+        tailLengthInSamples = linearPhaseEngine.getFirLengthInSamples();
+        tailLengthSeconds = static_cast<double> (tailLengthInSamples) / getSampleRate();
+        return;
+    }
 
-#ifdef USE_TEST_SIGNAL
-    buffer.clear();
-#endif
+    double tailLength = 0.0;
+    for (const auto* chain : { &leftChain, &rightChain })
+    {
+        LinearPhaseFirDesign::computeSections (tailBatch, LinearPhaseEngine::getChainParameters (*chain));
+        tailLength = juce::jmax (tailLength, TailLength::getTailLengthInSeconds (tailBatch, getSampleRate()));
+    }
+    tailLengthSeconds = tailLength;
+    tailLengthInSamples = static_cast<juce::int64> (std::ceil (tailLength * getSampleRate()));
 }
 
 //==============================================================================
@@ -279,10 +496,24 @@ void EqualizerAudioProcessor::setStateInformation (const void* data, int sizeInB
     if (tree.isValid())
     {
         apvts.replaceState (tree);
-        ChainHelpers::initializeChains (leftChain, rightChain, getSampleRate(), apvts);
+        ChainHelpers::initializeChains (leftChain, rightChain, getSampleRate(), parameterTable);
+        parameterTable.markEverythingChanged();
+        floatPath.laneChains.reset();
+        doublePath.laneChains.reset();
     }
 }
 
+bool EqualizerAudioProcessor::waitForFilters (int timeoutMs)
+{
+    // the biquads and the SVFs compute their coefficients on the calling thread in prepareToPlay() and processBlock()
+    if (getFilterEngine() != FilterEngine::LINEAR_PHASE)
+    {
+        return true;
+    }
+
+    return linearPhaseEngine.loadFirsAndWait (leftChain, rightChain, channelGroups, timeoutMs);
+}
+
 void EqualizerAudioProcessor::setGlobalBypass (bool bypassed)
 {
     setupBypassFilter<ChainPositions::LOWCUT> (bypassed);
@@ -323,6 +554,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout EqualizerAudioProcessor::cre
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
     addEqModeParameterToLayout (layout);
+    addChannelGroupParametersToLayout (layout);
+    addFilterEngineParameterToLayout (layout);
+    addCoefficientInterpolationParameterToLayout (layout);
     addGainTrimParameterToLayout (layout, "input_gain");
     addFilterParameterToLayout<ChainPositions::LOWCUT> (layout, true);
     addFilterParameterToLayout<ChainPositions::LOWSHELF> (layout, false);
@@ -346,6 +580,33 @@ void EqualizerAudioProcessor::addEqModeParameterToLayout (juce::AudioProcessorVa
                                                               0));
 }
 
+void EqualizerAudioProcessor::addChannelGroupParametersToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    for (size_t channel = 0; channel < ChannelGroups::MAX_CHANNELS; ++channel)
+    {
+        auto name = ChannelGroups::getParameterName (channel);
+        layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { name, 1 }, //
+                                                                  name,
+                                                                  ChannelGroups::getAssignmentNames(),
+                                                                  static_cast<int> (ChannelGroups::Assignment::AUTO)));
+    }
+}
+
+void EqualizerAudioProcessor::addFilterEngineParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "filter_engine", 1 },
+                                                              "filter_engine",
+                                                              juce::StringArray { "Biquad", "SVF", "Parallel", "Linear Phase" },
+                                                              0));
+}
+
+void EqualizerAudioProcessor::addCoefficientInterpolationParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "coefficient_interpolation", 1 },
+                                                            "coefficient_interpolation",
+                                                            false));
+}
+
 void EqualizerAudioProcessor::addGainTrimParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout,
                                                             const juce::String& name)
 {
@@ -369,49 +630,133 @@ juce::StringArray EqualizerAudioProcessor::getSlopeNames()
     return slopeNames;
 }
 
-float EqualizerAudioProcessor::getRawParameter (const juce::String& name)
+EqMode EqualizerAudioProcessor::getEqMode()
 {
-    return apvts.getRawParameterValue (name)->load();
+    return parameterTable.getEqMode();
 }
 
-EqMode EqualizerAudioProcessor::getEqMode()
+FilterEngine EqualizerAudioProcessor::getFilterEngine()
 {
-    return static_cast<EqMode> (getRawParameter ("eq_mode"));
+    return parameterTable.getFilterEngine();
 }
 
-void EqualizerAudioProcessor::updateParameters (EqMode mode)
+bool EqualizerAudioProcessor::isCoefficientInterpolationEnabled()
 {
-    updateCutParameters<ChainPositions::LOWCUT> (FilterInfo::FilterType::HIGHPASS, mode);
-    updateParametricParameters<ChainPositions::LOWSHELF> (FilterInfo::FilterType::LOWSHELF, mode);
-    updateParametricParameters<ChainPositions::PEAK1> (FilterInfo::FilterType::PEAKFILTER, mode);
-    updateParametricParameters<ChainPositions::PEAK2> (FilterInfo::FilterType::PEAKFILTER, mode);
-    updateParametricParameters<ChainPositions::PEAK3> (FilterInfo::FilterType::PEAKFILTER, mode);
-    updateParametricParameters<ChainPositions::PEAK4> (FilterInfo::FilterType::PEAKFILTER, mode);
-    updateParametricParameters<ChainPositions::HIGHSHELF> (FilterInfo::FilterType::HIGHSHELF, mode);
-    updateCutParameters<ChainPositions::HIGHCUT> (FilterInfo::FilterType::LOWPASS, mode);
+    return parameterTable.isCoefficientInterpolationEnabled();
 }
 
-void EqualizerAudioProcessor::updateFilters (int chunkSize)
+void EqualizerAudioProcessor::updateChannelGroups (EqMode mode)
+{
+    for (size_t channel = 0; channel < ChannelGroups::MAX_CHANNELS; ++channel)
+    {
+        auto assignment = parameterTable.getChannelGroupAssignment (channel);
+        channelGroups[channel] = ChannelGroups::getGroup (mode, assignment, channelTypes[channel], channel);
+    }
+}
+
+void EqualizerAudioProcessor::updateParameters (EqMode mode, uint32_t changes)
+{
+    if ((changes & ParameterTable::ALL_BANDS) == 0)
+    {
+        return;
+    }
+
+    updateCutParameters<ChainPositions::LOWCUT> (FilterInfo::FilterType::HIGHPASS, mode, changes);
+    updateParametricParameters<ChainPositions::LOWSHELF> (FilterInfo::FilterType::LOWSHELF, mode, changes);
+    updateParametricParameters<ChainPositions::PEAK1> (FilterInfo::FilterType::PEAKFILTER, mode, changes);
+    updateParametricParameters<ChainPositions::PEAK2> (FilterInfo::FilterType::PEAKFILTER, mode, changes);
+    updateParametricParameters<ChainPositions::PEAK3> (FilterInfo::FilterType::PEAKFILTER, mode, changes);
+    updateParametricParameters<ChainPositions::PEAK4> (FilterInfo::FilterType::PEAKFILTER, mode, changes);
+    updateParametricParameters<ChainPositions::HIGHSHELF> (FilterInfo::FilterType::HIGHSHELF, mode, changes);
+    updateCutParameters<ChainPositions::HIGHCUT> (FilterInfo::FilterType::LOWPASS, mode, changes);
+}
+
+bool EqualizerAudioProcessor::updateActiveBands()
+{
+    bool changed = false;
+    changed |= consumeActivityChange<ChainPositions::LOWCUT>();
+    changed |= consumeActivityChange<ChainPositions::LOWSHELF>();
+    changed |= consumeActivityChange<ChainPositions::PEAK1>();
+    changed |= consumeActivityChange<ChainPositions::PEAK2>();
+    changed |= consumeActivityChange<ChainPositions::PEAK3>();
+    changed |= consumeActivityChange<ChainPositions::PEAK4>();
+    changed |= consumeActivityChange<ChainPositions::HIGHSHELF>();
+    changed |= consumeActivityChange<ChainPositions::HIGHCUT>();
+
+    if (! changed)
+    {
+        return false;
+    }
+
+    numActiveBands = 0;
+    appendIfActive<ChainPositions::LOWCUT>();
+    appendIfActive<ChainPositions::LOWSHELF>();
+    appendIfActive<ChainPositions::PEAK1>();
+    appendIfActive<ChainPositions::PEAK2>();
+    appendIfActive<ChainPositions::PEAK3>();
+    appendIfActive<ChainPositions::PEAK4>();
+    appendIfActive<ChainPositions::HIGHSHELF>();
+    appendIfActive<ChainPositions::HIGHCUT>();
+    return true;
+}
+
+void EqualizerAudioProcessor::updateFilters (int chunkSize, bool interpolateCoefficients)
 {
     bool onRealTimeThread = ! juce::MessageManager::getInstanceWithoutCreating()->isThisTheMessageThread();
 
-    updateFilter<ChainPositions::LOWCUT> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::LOWSHELF> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::PEAK1> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::PEAK2> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::PEAK3> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::PEAK4> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::HIGHSHELF> (onRealTimeThread, chunkSize);
-    updateFilter<ChainPositions::HIGHCUT> (onRealTimeThread, chunkSize);
+    forEachActiveBand ([this, onRealTimeThread, chunkSize, interpolateCoefficients] (auto position)
+                       { updateFilter<decltype (position)::value> (onRealTimeThread, chunkSize, interpolateCoefficients); });
+}
+
+bool EqualizerAudioProcessor::isAnyActiveBandSmoothing()
+{
+    bool smoothing = false;
+    forEachActiveBand ([this, &smoothing] (auto position) { smoothing |= isFilterSmoothing<decltype (position)::value>(); });
+    return smoothing;
+}
+
+void EqualizerAudioProcessor::setSmoothingSubBlockSize (size_t numSamples)
+{
+    jassert (numSamples > 0);
+    smoothingSubBlockSize = juce::jmax (static_cast<size_t> (1), numSamples);
+}
+
+MemoryFootprint EqualizerAudioProcessor::getMemoryFootprint() const
+{
+    MemoryFootprint footprint;
+    // what sizeof (*this) has left once the subsystems below are taken out
+    auto otherMembersBytes = sizeof (*this);
+    auto addSubsystem = [&footprint, &otherMembersBytes] (const juce::String& subsystem, size_t embeddedBytes, size_t bytes)
+    {
+        otherMembersBytes -= embeddedBytes;
+        footprint.add (subsystem, bytes);
+    };
+
+    addSubsystem ("filter chains", sizeof (leftChain) + sizeof (rightChain), sizeof (leftChain) + sizeof (rightChain));
+    addSubsystem ("parameter table", sizeof (parameterTable), sizeof (parameterTable));
+    addSubsystem ("processing paths",
+                  sizeof (floatPath) + sizeof (doublePath),
+                  floatPath.getMemoryFootprint() + doublePath.getMemoryFootprint());
+    addSubsystem ("linear phase engine", sizeof (linearPhaseEngine), linearPhaseEngine.getMemoryFootprint());
+    addSubsystem ("meter fifos",
+                  sizeof (inMeterValuesFifo) + sizeof (outMeterValuesFifo),
+                  inMeterValuesFifo.getMemoryFootprint() + outMeterValuesFifo.getMemoryFootprint());
+    addSubsystem ("analyzer fifos",
+                  sizeof (spectrumAnalyzerFifoLeft) + sizeof (spectrumAnalyzerFifoRight),
+                  spectrumAnalyzerFifoLeft.getMemoryFootprint() + spectrumAnalyzerFifoRight.getMemoryFootprint());
+    footprint.add ("other members", otherMembersBytes);
+
+    return footprint;
 }
 
-void EqualizerAudioProcessor::updateTrimGains()
+template <typename SampleType>
+void EqualizerAudioProcessor::updateTrimGains (ProcessingPath<SampleType>& path)
 {
-    auto inputGainRaw = getRawParameter ("input_gain");
-    auto outputGainRaw = getRawParameter ("output_gain");
+    auto inputGainRaw = parameterTable.getInputGainDecibels();
+    auto outputGainRaw = parameterTable.getOutputGainDecibels();
 
-    inputGain.setGainDecibels (inputGainRaw);
-    outputGain.setGainDecibels (outputGainRaw);
+    path.inputGain.setGainDecibels (static_cast<SampleType> (inputGainRaw));
+    path.outputGain.setGainDecibels (static_cast<SampleType> (outputGainRaw));
 }
 
 void EqualizerAudioProcessor::initializeOrder()
@@ -427,9 +772,7 @@ void EqualizerAudioProcessor::initializeOrder()
 #if USE_TEST_SIGNAL
 FFTOrder EqualizerAudioProcessor::getCurrentFFTOrder()
 {
-    auto params = AnalyzerProperties::GetAnalyzerParams();
-    auto fftOrderName = params.at (AnalyzerProperties::ParamNames::AnalyzerPoints);
-    auto fftOrder = apvts.getRawParameterValue (fftOrderName)->load();
+    auto fftOrder = parameterTable.getAnalyzerPoints();
     auto lowestFFTOrder = static_cast<int> (FFTOrder::order2048);
     return static_cast<FFTOrder> (fftOrder + lowestFFTOrder);
 }
@@ -10,15 +10,28 @@
 
 #include "data/MeterValues.h"
 #include "utils/ChainHelpers.h"
+#include "utils/ChannelGroups.h"
 #include "utils/EqParam.h"
 #include "utils/FilterParam.h"
 #include "utils/FilterType.h"
+#include "utils/FusedBlockPipeline.h"
+#include "utils/LaneChain.h"
+#include "utils/LinearPhaseEngine.h"
+#include "utils/MemoryFootprint.h"
 #include "utils/MidSideProcessor.h"
+#include "utils/MultichannelChain.h"
+#include "utils/ParameterTable.h"
+#include "utils/SilenceDetector.h"
 #include "utils/SingleChannelSampleFifo.h"
+#include "utils/SpscRing.h"
+#include "utils/SvfChain.h"
+#include "utils/TailLength.h"
 #include <JuceHeader.h>
 
 // ====================================================================================================
-class EqualizerAudioProcessor : public juce::AudioProcessor
+class EqualizerAudioProcessor
+    : public juce::AudioProcessor
+    , private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -34,6 +47,8 @@ public:
 #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -58,18 +73,46 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    /*
+     while any band is smoothing, the filters are updated every 'numSamples' samples.
+     this is the control rate of the stepped mode: with coefficient interpolation
+     the filters are updated every INTERPOLATED_SMOOTHING_SUB_BLOCK_SIZE samples.
+     */
+    void setSmoothingSubBlockSize (size_t numSamples);
+
+    /*
+     the bytes this instance holds, per subsystem, once prepared: the size of its fifos
+     and buffers depends on the channel count, the sample rate and the block size.
+     the analyzer of the editor is not included, see PathProducer::getMemoryFootprint().
+     */
+    MemoryFootprint getMemoryFootprint() const;
+
+    /*
+     offline rendering, after prepareToPlay() and not on the audio thread: waits until the
+     filters of the current parameters are ready. the linear phase FIRs are designed and
+     loaded in the background, without waiting the first blocks would go through the
+     previous FIRs and a crossfade. false if that takes more than 'timeoutMs'.
+     */
+    bool waitForFilters (int timeoutMs);
+
     void setGlobalBypass (bool bypass);
     bool isAnyFilterActive();
 
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Params", createParameterLayout() };
 
-    Fifo<MeterValues, 20> inMeterValuesFifo;
-    Fifo<MeterValues, 20> outMeterValuesFifo;
+    const ParameterTable& getParameterTable() const
+    {
+        return parameterTable;
+    }
+
+    SpscRing<MeterValues, 32> inMeterValuesFifo;
+    SpscRing<MeterValues, 32> outMeterValuesFifo;
 
     SingleChannelSampleFifo<juce::AudioBuffer<float>> spectrumAnalyzerFifoLeft { Channel::LEFT };
     SingleChannelSampleFifo<juce::AudioBuffer<float>> spectrumAnalyzerFifoRight { Channel::RIGHT };
 
-    using GainTrim = juce::dsp::Gain<float>;
+    template <typename SampleType>
+    using GainTrim = juce::dsp::Gain<SampleType>;
 
     struct SampleRateListener
     {
@@ -143,66 +186,267 @@ private:
     }
 
     static void addEqModeParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+    static void addChannelGroupParametersToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+    static void addFilterEngineParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+    static void addCoefficientInterpolationParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
     static void addGainTrimParameterToLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout, const juce::String& name);
 
     static juce::StringArray getSlopeNames();
 
-    float getRawParameter (const juce::String& name);
+    // every parameter the audio thread reads, resolved once: apvts is declared before it
+    ParameterTable parameterTable { apvts };
 
     EqMode getEqMode();
+    FilterEngine getFilterEngine();
+    bool isCoefficientInterpolationEnabled();
 
-    void updateParameters (EqMode mode);
+    // the group of every channel of the bus, for 'mode' and the channel_group parameters
+    void updateChannelGroups (EqMode mode);
+
+    ChainHelpers::MonoChain& getChain (Channel group)
+    {
+        return group == Channel::LEFT ? leftChain : rightChain;
+    }
+
+    // re-reads the bands set in 'changes', see ParameterTable::consumeChanges()
+    void updateParameters (EqMode mode, uint32_t changes);
 
     template <ChainPositions FilterPosition>
-    void updateCutParameters (FilterInfo::FilterType filterType, EqMode mode)
+    void updateCutParameters (FilterInfo::FilterType filterType, EqMode mode, uint32_t changes)
     {
         const int filterIndex = static_cast<int> (FilterPosition);
-        auto leftCutParams = ChainHelpers::getCutParameters<filterIndex> (Channel::LEFT, filterType, getSampleRate(), apvts);
+        if ((changes & ParameterTable::getBandMask (static_cast<size_t> (filterIndex))) == 0)
+        {
+            return;
+        }
+
+        auto leftCutParams = ChainHelpers::getCutParameters<filterIndex> (Channel::LEFT, filterType, getSampleRate(), parameterTable);
         leftChain.get<filterIndex>().performPreloopUpdate (leftCutParams);
 
         auto rightCutParams = mode == EqMode::STEREO
                                   ? leftCutParams //
-                                  : ChainHelpers::getCutParameters<filterIndex> (Channel::RIGHT, filterType, getSampleRate(), apvts);
+                                  : ChainHelpers::getCutParameters<filterIndex> (Channel::RIGHT, filterType, getSampleRate(), parameterTable);
         rightChain.get<filterIndex>().performPreloopUpdate (rightCutParams);
+        setSvfParameters (filterIndex, leftCutParams, rightCutParams);
     }
 
     template <ChainPositions FilterPosition>
-    void updateParametricParameters (FilterInfo::FilterType filterType, EqMode mode)
+    void updateParametricParameters (FilterInfo::FilterType filterType, EqMode mode, uint32_t changes)
     {
         const int filterIndex = static_cast<int> (FilterPosition);
-        auto leftParametricParams = ChainHelpers::getParametricParameters<filterIndex> (Channel::LEFT, filterType, getSampleRate(), apvts);
+        if ((changes & ParameterTable::getBandMask (static_cast<size_t> (filterIndex))) == 0)
+        {
+            return;
+        }
+
+        auto leftParametricParams = ChainHelpers::getParametricParameters<filterIndex> (Channel::LEFT, filterType, getSampleRate(), parameterTable);
         leftChain.get<filterIndex>().performPreloopUpdate (leftParametricParams);
 
         auto rightParametricParams = mode == EqMode::STEREO ? leftParametricParams //
                                                             : ChainHelpers::getParametricParameters<filterIndex> (Channel::RIGHT,
                                                                                                                   filterType,
                                                                                                                   getSampleRate(),
-                                                                                                                  apvts);
+                                                                                                                  parameterTable);
         rightChain.get<filterIndex>().performPreloopUpdate (rightParametricParams);
+        setSvfParameters (filterIndex, leftParametricParams, rightParametricParams);
     }
 
-    void updateFilters (int chunkSize);
+    // true when a band became active or inactive
+    bool updateActiveBands();
 
     template <ChainPositions FilterPosition>
-    void updateFilter (bool onRealTimeThread, int chunkSize)
+    bool consumeActivityChange()
     {
         const int filterIndex = static_cast<int> (FilterPosition);
-        leftChain.get<filterIndex>().performInnerLoopFilterUpdate (onRealTimeThread, chunkSize);
-        rightChain.get<filterIndex>().performInnerLoopFilterUpdate (onRealTimeThread, chunkSize);
+        auto leftChanged = leftChain.get<filterIndex>().consumeActivityChange();
+        auto rightChanged = rightChain.get<filterIndex>().consumeActivityChange();
+        return leftChanged || rightChanged;
     }
 
-    template <typename FifoType, typename BufferType>
-    void updateMeterFifos (FifoType& fifo, BufferType& buffer)
+    template <ChainPositions FilterPosition>
+    void appendIfActive()
     {
-        const auto leftChannel = static_cast<int> (Channel::LEFT);
-        const auto rightChannel = static_cast<int> (Channel::RIGHT);
-        MeterValues meterValues;
-        meterValues.leftPeakDb.setGain (buffer.getMagnitude (leftChannel, 0, buffer.getNumSamples()));
-        meterValues.rightPeakDb.setGain (buffer.getMagnitude (rightChannel, 0, buffer.getNumSamples()));
-        meterValues.leftRmsDb.setGain (buffer.getRMSLevel (leftChannel, 0, buffer.getNumSamples()));
-        meterValues.rightRmsDb.setGain (buffer.getRMSLevel (rightChannel, 0, buffer.getNumSamples()));
-
-        fifo.push (meterValues);
+        const int filterIndex = static_cast<int> (FilterPosition);
+        if (leftChain.get<filterIndex>().isActive() || rightChain.get<filterIndex>().isActive())
+        {
+            activeBands[numActiveBands++] = FilterPosition;
+        }
+    }
+
+    template <typename Function>
+    void forEachActiveBand (Function&& function)
+    {
+        for (size_t i = 0; i < numActiveBands; ++i)
+        {
+            switch (activeBands[i])
+            {
+                case ChainPositions::LOWCUT:
+                    function (std::integral_constant<ChainPositions, ChainPositions::LOWCUT> {});
+                    break;
+                case ChainPositions::LOWSHELF:
+                    function (std::integral_constant<ChainPositions, ChainPositions::LOWSHELF> {});
+                    break;
+                case ChainPositions::PEAK1:
+                    function (std::integral_constant<ChainPositions, ChainPositions::PEAK1> {});
+                    break;
+                case ChainPositions::PEAK2:
+                    function (std::integral_constant<ChainPositions, ChainPositions::PEAK2> {});
+                    break;
+                case ChainPositions::PEAK3:
+                    function (std::integral_constant<ChainPositions, ChainPositions::PEAK3> {});
+                    break;
+                case ChainPositions::PEAK4:
+                    function (std::integral_constant<ChainPositions, ChainPositions::PEAK4> {});
+                    break;
+                case ChainPositions::HIGHSHELF:
+                    function (std::integral_constant<ChainPositions, ChainPositions::HIGHSHELF> {});
+                    break;
+                case ChainPositions::HIGHCUT:
+                    function (std::integral_constant<ChainPositions, ChainPositions::HIGHCUT> {});
+                    break;
+            }
+        }
+    }
+
+    void updateFilters (int chunkSize, bool interpolateCoefficients);
+
+    bool isAnyActiveBandSmoothing();
+
+    template <ChainPositions FilterPosition>
+    bool isFilterSmoothing()
+    {
+        const int filterIndex = static_cast<int> (FilterPosition);
+        return leftChain.get<filterIndex>().isSmoothing() || rightChain.get<filterIndex>().isSmoothing();
+    }
+
+    /*
+     everything that touches samples, once per sample type. the host picks single
+     or double precision before calling prepareToPlay and only that path runs.
+     */
+    template <typename SampleType>
+    struct ProcessingPath
+    {
+        MultichannelChain<SampleType> laneChains;
+        std::array<SvfChain<SampleType>, ChannelGroups::MAX_CHANNELS> svfChains;
+        GainTrim<SampleType> inputGain, outputGain;
+        FusedBlockPipeline::Meter<SampleType> inputMeter, outputMeter;
+
+        size_t getMemoryFootprint() const
+        {
+            return sizeof (*this) - sizeof (laneChains) + laneChains.getMemoryFootprint();
+        }
+    };
+
+    template <typename SampleType>
+    ProcessingPath<SampleType>& getProcessingPath()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+        {
+            return doublePath;
+        }
+        else
+        {
+            return floatPath;
+        }
+    }
+
+    template <typename ParamType>
+    void setSvfParameters (int filterIndex, const ParamType& leftParams, const ParamType& rightParams)
+    {
+        if (isUsingDoublePrecision())
+        {
+            setSvfParameters (doublePath, filterIndex, leftParams, rightParams);
+        }
+        else
+        {
+            setSvfParameters (floatPath, filterIndex, leftParams, rightParams);
+        }
+    }
+
+    template <typename SampleType, typename ParamType>
+    void setSvfParameters (ProcessingPath<SampleType>& path, int filterIndex, const ParamType& leftParams, const ParamType& rightParams)
+    {
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            path.svfChains[channel].setParameters (filterIndex, channelGroups[channel] == Channel::LEFT ? leftParams : rightParams);
+        }
+    }
+
+    template <typename SampleType>
+    void prepareProcessingPath (ProcessingPath<SampleType>& path, const juce::dsp::ProcessSpec& spec);
+
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer);
+
+    template <typename SampleType>
+    void processBiquadEngine (juce::dsp::AudioBlock<SampleType>& block, bool useParallelForm, bool interpolate, bool midSide);
+
+    template <typename SampleType>
+    void processSvfEngine (juce::dsp::AudioBlock<SampleType>& block, bool midSide);
+
+    template <typename SampleType>
+    void processLinearPhaseEngine (juce::dsp::AudioBlock<SampleType>& block, bool midSide);
+
+    /*
+     in mid/side mode the first two channels are encoded right before 'processChunk' filters
+     a chunk and decoded right after, while the chunk is still in L1: mid/side costs no
+     extra pass over the buffer.
+     */
+    template <typename SampleType, typename ProcessChunk>
+    void processWithMidSide (juce::dsp::AudioBlock<SampleType>& block, bool midSide, ProcessChunk&& processChunk)
+    {
+        if (! midSide)
+        {
+            processChunk (block);
+            return;
+        }
+
+        for (size_t offset = 0; offset < block.getNumSamples(); offset += MID_SIDE_CHUNK_SIZE)
+        {
+            auto numSamples = juce::jmin (MID_SIDE_CHUNK_SIZE, block.getNumSamples() - offset);
+            auto chunk = block.getSubBlock (offset, numSamples);
+            auto* left = chunk.getChannelPointer (static_cast<size_t> (Channel::LEFT));
+            auto* right = chunk.getChannelPointer (static_cast<size_t> (Channel::RIGHT));
+
+            MidSideProcessor::process (left, right, numSamples);
+            processChunk (chunk);
+            MidSideProcessor::process (left, right, numSamples);
+        }
+    }
+
+    /*
+     when 'engine' changes: ends the ramps of the links (see FilterLink::skipSmoothing()) and
+     has its latency reported to the host from the message thread, see handleAsyncUpdate().
+     */
+    void updateEngine (FilterEngine engine);
+
+    // the linear phase engine is the only one with latency
+    int getLatencyInSamples (FilterEngine engine);
+
+    // reports the latency of the current engine, the host isn't notified from the audio thread
+    void handleAsyncUpdate() override;
+
+    template <ChainPositions FilterPosition>
+    void skipSmoothing()
+    {
+        const int filterIndex = static_cast<int> (FilterPosition);
+        leftChain.get<filterIndex>().skipSmoothing();
+        rightChain.get<filterIndex>().skipSmoothing();
+    }
+
+    /*
+     recomputes the tail reported by getTailLengthSeconds() when the engine changes or when
+     'targetsChanged': ParameterTable::consumeChanges() returned a bit or a band became
+     active or inactive, the target parameters of the chains don't change otherwise.
+     */
+    void updateTailLength (FilterEngine engine, bool targetsChanged);
+
+    template <ChainPositions FilterPosition>
+    void updateFilter (bool onRealTimeThread, int chunkSize, bool interpolateCoefficients)
+    {
+        const int filterIndex = static_cast<int> (FilterPosition);
+        leftChain.get<filterIndex>().performInnerLoopFilterUpdate (onRealTimeThread, chunkSize, interpolateCoefficients);
+        rightChain.get<filterIndex>().performInnerLoopFilterUpdate (onRealTimeThread, chunkSize, interpolateCoefficients);
     }
 
     template <ChainPositions FilterPosition>
@@ -236,16 +480,46 @@ private:
     template <ChainPositions FilterPosition, Channel FilterChannel>
     bool isMonoFilterActive()
     {
-        auto bypassName = FilterInfo::getParameterName (static_cast<int> (FilterPosition), FilterChannel, FilterInfo::FilterParam::BYPASS);
-        return getRawParameter (bypassName) < 0.5f;
+        const int filterIndex = static_cast<int> (FilterPosition);
+        return parameterTable.getFilterParameter (filterIndex, FilterChannel, FilterInfo::FilterParam::BYPASS) < 0.5f;
     }
 
-    void updateTrimGains();
+    template <typename SampleType>
+    void updateTrimGains (ProcessingPath<SampleType>& path);
 
+    // one chain per group, see ChannelGroups
     ChainHelpers::MonoChain leftChain, rightChain;
-    GainTrim inputGain, outputGain;
-
-    MidSideProcessor midSideProcessor;
+    ChannelGroups::ChannelTypes channelTypes {};
+    ChannelGroups::Groups channelGroups {};
+    size_t numChannels = 2;
+    /*
+     bands that are active in at least one channel, in chain order.
+     rebuilt by updateActiveBands() only when a bypass, gain or type changes.
+     */
+    std::array<ChainPositions, 8> activeBands;
+    size_t numActiveBands = 0;
+
+    static const size_t DEFAULT_SMOOTHING_SUB_BLOCK_SIZE = 32;
+    static const size_t INTERPOLATED_SMOOTHING_SUB_BLOCK_SIZE = 128;
+    std::atomic<size_t> smoothingSubBlockSize { DEFAULT_SMOOTHING_SUB_BLOCK_SIZE };
+    ProcessingPath<float> floatPath;
+    ProcessingPath<double> doublePath;
+
+    // the chunks of the FusedBlockPipeline go through in one piece
+    static const size_t MID_SIDE_CHUNK_SIZE = FusedBlockPipeline::CHUNK_SIZE;
+
+    LinearPhaseEngine linearPhaseEngine;
+    FilterEngine latencyEngine = FilterEngine::BIQUAD;
+
+    SilenceDetector silenceDetector;
+    // written on the audio thread, read by the host on any thread
+    std::atomic<double> tailLengthSeconds { 0.0 };
+    // the same, for the SilenceDetector
+    juce::int64 tailLengthInSamples = 0;
+    FilterEngine tailEngine = FilterEngine::BIQUAD;
+    LinearPhaseFirDesign::ChainBatch tailBatch;
+    // the target parameters changed since the linear phase engine last took them, see LinearPhaseEngine::update()
+    bool linearPhaseDesignPending = true;
 
 #if USE_TEST_SIGNAL
     juce::dsp::Gain<float> testGain;
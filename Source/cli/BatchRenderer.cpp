@@ -0,0 +1,291 @@
+#include "cli/BatchRenderer.h"
+#include "PluginProcessor.h"
+#include "utils/ChannelGroups.h"
+
+namespace
+{
+// how far the io thread decodes ahead of the processing, and how much output it can lag behind
+const int READ_AHEAD_SAMPLES = 1 << 16;
+const int WRITE_BUFFER_SAMPLES = 1 << 16;
+// how long the linear phase FIRs can take to be designed and loaded before a file fails
+const int FILTER_TIMEOUT_MS = 30000;
+} // namespace
+
+struct BatchRenderer::Job : juce::ThreadPoolJob
+{
+    Job (const juce::File& inputFile, const juce::File& outputFile) : juce::ThreadPoolJob (inputFile.getFileName())
+    {
+        result.input = inputFile;
+        result.output = outputFile;
+    }
+
+    // on the message thread
+    bool setup (juce::AudioFormatManager& formatManager, const Options& options)
+    {
+        ioThread.startThread();
+
+        reader = createReader (formatManager, result.input);
+        if (reader == nullptr)
+        {
+            return fail ("can't read " + result.input.getFullPathName());
+        }
+
+        numChannels = static_cast<int> (reader->numChannels);
+        if (numChannels == 0 || numChannels > static_cast<int> (ChannelGroups::MAX_CHANNELS))
+        {
+            return fail (juce::String (numChannels) + " channels, the equalizer handles 1 to "
+                         + juce::String (ChannelGroups::MAX_CHANNELS));
+        }
+
+        auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.outputBuses.add (channelSet);
+        if (! processor.setBusesLayout (layout))
+        {
+            return fail ("unsupported channel layout " + channelSet.getDescription());
+        }
+
+        blockSize = options.blockSize;
+        processor.setNonRealtime (true);
+        processor.setRateAndBufferSizeDetails (reader->sampleRate, blockSize);
+        processor.setStateInformation (options.state.getData(), static_cast<int> (options.state.getSize()));
+        processor.prepareToPlay (reader->sampleRate, blockSize);
+
+        // every render of a file is the same: no block goes through filters that aren't ready yet
+        if (! processor.waitForFilters (FILTER_TIMEOUT_MS))
+        {
+            return fail ("the linear phase filters weren't ready in time");
+        }
+
+        writer = createWriter (formatManager);
+        if (writer == nullptr)
+        {
+            return fail ("can't write " + result.output.getFullPathName());
+        }
+
+        return true;
+    }
+
+    JobStatus runJob() override
+    {
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midiMessages;
+
+        const auto length = reader->lengthInSamples;
+        juce::int64 readPosition = 0;
+        juce::int64 numWritten = 0;
+        // the first output samples are the latency, they are dropped and the input is padded with as many zeros
+        auto numSamplesToDrop = processor.getLatencySamples();
+
+        while (numWritten < length)
+        {
+            if (shouldExit())
+            {
+                result.error = "cancelled";
+                break;
+            }
+
+            buffer.clear();
+            auto numToRead = static_cast<int> (juce::jmin (static_cast<juce::int64> (blockSize), length - readPosition));
+            if (numToRead > 0 && ! reader->read (&buffer, 0, numToRead, readPosition, true, true))
+            {
+                result.error = "read error in " + result.input.getFullPathName();
+                break;
+            }
+            readPosition += numToRead;
+
+            processor.processBlock (buffer, midiMessages);
+
+            auto start = juce::jmin (numSamplesToDrop, blockSize);
+            numSamplesToDrop -= start;
+            auto numToWrite = static_cast<int> (juce::jmin (static_cast<juce::int64> (blockSize - start), length - numWritten));
+            if (numToWrite > 0 && ! write (buffer, start, numToWrite))
+            {
+                break;
+            }
+            numWritten += numToWrite;
+        }
+
+        // flushes what the io thread didn't write yet
+        writer.reset();
+        processor.releaseResources();
+
+        if (result.error.isNotEmpty())
+        {
+            result.output.deleteFile();
+        }
+
+        return jobHasFinished;
+    }
+
+    Result result;
+
+private:
+    bool fail (const juce::String& error)
+    {
+        result.error = error;
+        return false;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> createReader (juce::AudioFormatManager& formatManager, const juce::File& file)
+    {
+        if (auto* format = formatManager.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader (format->createMemoryMappedReader (file));
+            if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            {
+                return mappedReader;
+            }
+        }
+
+        auto* sourceReader = formatManager.createReaderFor (file);
+        if (sourceReader == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto bufferingReader = std::make_unique<juce::BufferingAudioReader> (sourceReader, ioThread, READ_AHEAD_SAMPLES);
+        // offline: wait for the io thread rather than reading silence
+        bufferingReader->setReadTimeout (-1);
+        return bufferingReader;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> createWriter (juce::AudioFormatManager& formatManager)
+    {
+        auto* format = formatManager.findFormatForFileExtension (result.output.getFileExtension());
+        if (format == nullptr)
+        {
+            return nullptr;
+        }
+
+        result.output.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream (result.output.createOutputStream());
+        if (stream == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto bitDepths = format->getPossibleBitDepths();
+        auto bitsPerSample = bitDepths.contains (static_cast<int> (reader->bitsPerSample)) ? static_cast<int> (reader->bitsPerSample)
+                                                                                           : bitDepths.getLast();
+
+        auto* formatWriter = format->createWriterFor (stream.get(),
+                                                      reader->sampleRate,
+                                                      static_cast<unsigned int> (numChannels),
+                                                      bitsPerSample,
+                                                      reader->metadataValues,
+                                                      0);
+        if (formatWriter == nullptr)
+        {
+            return nullptr;
+        }
+
+        // the writer owns the stream now
+        stream.release();
+        return std::make_unique<juce::AudioFormatWriter::ThreadedWriter> (formatWriter, ioThread, WRITE_BUFFER_SAMPLES);
+    }
+
+    bool write (const juce::AudioBuffer<float>& buffer, int start, int numSamples)
+    {
+        std::array<const float*, ChannelGroups::MAX_CHANNELS> channels {};
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            channels[static_cast<size_t> (channel)] = buffer.getReadPointer (channel, start);
+        }
+
+        // the io thread is behind: wait for it to make room
+        while (! writer->write (channels.data(), numSamples))
+        {
+            if (shouldExit())
+            {
+                result.error = "cancelled";
+                return false;
+            }
+            juce::Thread::sleep (1);
+        }
+
+        return true;
+    }
+
+    // declared first: the reader and the writer stop using it before it stops
+    juce::TimeSliceThread ioThread { "render io" };
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer;
+    EqualizerAudioProcessor processor;
+    int numChannels = 0;
+    int blockSize = 0;
+};
+
+BatchRenderer::BatchRenderer (Options optionsToUse) : options (std::move (optionsToUse))
+{
+    jassert (options.blockSize > 0 && options.numThreads > 0);
+    formatManager.registerBasicFormats();
+}
+
+std::vector<BatchRenderer::Result> BatchRenderer::render (const juce::Array<juce::File>& inputFiles)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    juce::ThreadPool pool (options.numThreads);
+    std::vector<std::unique_ptr<Job>> jobs;
+    std::vector<Result> results;
+    juce::Array<juce::File> outputs;
+
+    for (const auto& input : inputFiles)
+    {
+        // only the files being rendered have a processor: wait for a free thread
+        while (pool.getNumJobs() >= options.numThreads)
+        {
+            juce::Thread::sleep (5);
+        }
+
+        auto job = std::make_unique<Job> (input, options.outputDirectory.getChildFile (input.getFileName()));
+        if (job->result.output == input)
+        {
+            job->result.error = "the output would overwrite the input";
+            results.push_back (job->result);
+            continue;
+        }
+
+        // inputs with the same name in different directories: the first one gets the output
+        if (outputs.contains (job->result.output))
+        {
+            job->result.error = "another input has the same name, its output would be overwritten";
+            results.push_back (job->result);
+            continue;
+        }
+        outputs.add (job->result.output);
+
+        if (! job->setup (formatManager, options))
+        {
+            results.push_back (job->result);
+            continue;
+        }
+
+        pool.addJob (job.get(), false);
+        jobs.push_back (std::move (job));
+
+        // the processors of the jobs that are done are released as we go
+        for (auto it = jobs.begin(); it != jobs.end();)
+        {
+            if (! pool.contains (it->get()))
+            {
+                results.push_back ((*it)->result);
+                it = jobs.erase (it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (auto& job : jobs)
+    {
+        pool.waitForJobToFinish (job.get(), -1);
+        results.push_back (job->result);
+    }
+
+    return results;
+}
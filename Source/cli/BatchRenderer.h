@@ -0,0 +1,45 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ renders audio files through an EqualizerAudioProcessor, without a host or a GUI.
+ every file gets its own processor, set up with the same state (the format of
+ getStateInformation()), and the files are rendered in parallel, one per thread.
+ - a processor is set up on the calling thread, the message thread: its filters are
+   designed there, before its first block.
+ - formats that can be memory mapped (wav, aiff) are read straight from the mapping,
+   the others are decoded ahead of the processing on an io thread. the output is
+   encoded and written on that io thread too, the rendering thread only filters.
+ - the output has the length of the input: the latency of the processor is compensated.
+ - the outputs have the names of the inputs: of several inputs with the same name,
+   only the first one is rendered, the others fail.
+ */
+struct BatchRenderer
+{
+    struct Options
+    {
+        juce::MemoryBlock state;
+        juce::File outputDirectory;
+        int blockSize = 512;
+        int numThreads = juce::SystemStats::getNumCpus();
+    };
+
+    struct Result
+    {
+        juce::File input, output;
+        // empty when the file was rendered
+        juce::String error;
+    };
+
+    explicit BatchRenderer (Options optionsToUse);
+
+    // on the message thread, returns once every file was rendered or failed
+    std::vector<Result> render (const juce::Array<juce::File>& inputFiles);
+
+private:
+    struct Job;
+
+    Options options;
+    juce::AudioFormatManager formatManager;
+};
@@ -0,0 +1,94 @@
+#include "cli/BatchRenderer.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace
+{
+void printUsage()
+{
+    std::cout << "usage: EqualizerRender --state=<file> --output=<directory> [--jobs=<n>] [--block-size=<n>] <audio files>\n"
+                 "  --state       a state saved with getStateInformation()\n"
+                 "  --output      where the rendered files go, under the names of the inputs\n"
+                 "  --jobs        how many files are rendered at once, the number of cores by default\n"
+                 "  --block-size  the block size the processor runs with, 512 by default\n";
+}
+
+int fail (const juce::String& message)
+{
+    std::cerr << message << "\n";
+    return 1;
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList arguments (argc, argv);
+
+    if (arguments.size() == 0 || arguments.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    BatchRenderer::Options options;
+
+    auto stateFile = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--state"));
+    if (! arguments.containsOption ("--state") || ! stateFile.loadFileAsData (options.state))
+    {
+        return fail ("can't read the state, see --state");
+    }
+
+    options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--output"));
+    if (! arguments.containsOption ("--output") || ! options.outputDirectory.createDirectory())
+    {
+        return fail ("can't create the output directory, see --output");
+    }
+
+    if (arguments.containsOption ("--jobs"))
+    {
+        options.numThreads = arguments.getValueForOption ("--jobs").getIntValue();
+    }
+
+    if (arguments.containsOption ("--block-size"))
+    {
+        options.blockSize = arguments.getValueForOption ("--block-size").getIntValue();
+    }
+
+    if (options.numThreads <= 0 || options.blockSize <= 0)
+    {
+        return fail ("--jobs and --block-size need a positive value");
+    }
+
+    juce::Array<juce::File> inputFiles;
+    for (const auto& argument : arguments.arguments)
+    {
+        if (! argument.isOption())
+        {
+            inputFiles.add (argument.resolveAsFile());
+        }
+    }
+
+    if (inputFiles.isEmpty())
+    {
+        return fail ("no audio files to render");
+    }
+
+    BatchRenderer renderer (options);
+
+    int numFailures = 0;
+    for (const auto& result : renderer.render (inputFiles))
+    {
+        if (result.error.isEmpty())
+        {
+            std::cout << result.input.getFullPathName() << " -> " << result.output.getFullPathName() << "\n";
+        }
+        else
+        {
+            std::cerr << result.input.getFullPathName() << ": " << result.error << "\n";
+            ++numFailures;
+        }
+    }
+
+    return numFailures == 0 ? 0 : 1;
+}
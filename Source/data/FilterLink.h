@@ -1,38 +1,13 @@
 #pragma once
 
 #include "data/FilterParameters.h"
+#include "utils/BiquadSection.h"
 #include "utils/Decibel.h"
-#include "utils/Fifo.h"
 #include "utils/FilterCoefficientGenerator.h"
-#include "utils/ReleasePool.h"
+#include "utils/Mailbox.h"
+#include "utils/SectionRecord.h"
 #include <JuceHeader.h>
 
-using Filter = juce::dsp::IIR::Filter<float>;
-using Coefficients = juce::dsp::IIR::Coefficients<float>;
-using CoefficientsPtr = Coefficients::Ptr;
-using CutCoefficients = juce::ReferenceCountedArray<Coefficients>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-
-template <typename FilterType>
-struct IsCutFilter : std::false_type
-{
-};
-
-template <>
-struct IsCutFilter<CutFilter> : std::true_type
-{
-};
-
-template <typename FilterType>
-struct IsParametricFilter : std::false_type
-{
-};
-
-template <>
-struct IsParametricFilter<Filter> : std::true_type
-{
-};
-
 template <typename ParamType>
 struct IsCutParameter : std::false_type
 {
@@ -43,29 +18,18 @@ struct IsCutParameter<HighCutLowCutParameters> : std::true_type
 {
 };
 
-template <typename FilterType, typename FifoDataType, typename ParamType, typename FunctionType>
+/*
+ a band of a MonoChain. its coefficients are SectionRecords, computed from its parameters
+ on the CoefficientWorkerPool and handed over by value through a Mailbox: the audio thread
+ never allocates, frees or releases them, and gets the latest ones with a single exchange.
+ a link doesn't filter, it holds the record the engines (LaneChain, SvfChain, LinearPhaseEngine)
+ build their own filters from.
+ */
+template <typename FifoDataType, typename ParamType, typename FunctionType>
 struct FilterLink
 {
-    void prepare (const juce::dsp::ProcessSpec& spec)
-    {
-        filter.prepare (spec);
-    }
-
-    void reset()
-    {
-        filter.reset();
-    }
-
-    template <typename ContextType>
-    void process (const ContextType& context)
-    {
-        if (currentParams.bypassed)
-        {
-            return;
-        }
-
-        filter.process (context);
-    }
+    static const size_t MAX_SECTIONS = FifoDataType::MAX_SECTIONS;
+    using Sections = std::array<BiquadSection<float>, MAX_SECTIONS>;
 
     void updateSmootherTargets()
     {
@@ -103,6 +67,26 @@ struct FilterLink
         }
     }
 
+    /*
+     ends the ramps at once, at the current parameters. for the engines that don't filter
+     with the link: they never advance its smoothers, which would otherwise resume a stale
+     ramp when the link filters again.
+     */
+    void skipSmoothing()
+    {
+        freqSmoother.setCurrentAndTargetValue (currentParams.frequency);
+        qualitySmoother.setCurrentAndTargetValue (currentParams.quality);
+        if constexpr (! IsCutParameter<ParamType>::value)
+        {
+            gainSmoother.setCurrentAndTargetValue (currentParams.gain);
+        }
+
+        wasSmoothing = false;
+        shouldComputeNewCoefficients = true;
+        // a band that was ramping towards 0 dB is an identity now
+        activityChanged = true;
+    }
+
     bool isSmoothing() const
     {
         auto freqSmoothing = freqSmoother.isSmoothing();
@@ -117,10 +101,19 @@ struct FilterLink
 
     void checkIfStillSmoothing()
     {
-        if (isSmoothing())
+        auto smoothing = isSmoothing();
+        if (smoothing)
+        {
+            shouldComputeNewCoefficients = true;
+        }
+        else if (wasSmoothing)
         {
+            // the ramp ended, let the generator compute the coefficients of the target
             shouldComputeNewCoefficients = true;
+            // a gain ramp towards 0 dB only turns the band into an identity once it's over
+            activityChanged = true;
         }
+        wasSmoothing = smoothing;
     }
 
     void advanceSmoothers (int numSamples)
@@ -137,58 +130,50 @@ struct FilterLink
     {
         if (params != currentParams)
         {
+            if (affectsActivity (params))
+            {
+                activityChanged = true;
+            }
             shouldComputeNewCoefficients = true;
             currentParams = params;
         }
     }
 
-    void updateCoefficients (const FifoDataType& coefficents)
+    void setRecord (const FifoDataType& newRecord)
     {
-        if constexpr (IsCutFilter<FilterType>::value)
-        {
-            configureCutFilterChain (coefficents);
-        }
-        else
-        {
-            updateFilterState (filter.coefficients, coefficents);
-        }
+        record = newRecord;
+        ++coefficientsVersion;
+    }
+
+    const FifoDataType& getRecord() const
+    {
+        return record;
     }
 
-    void loadCoefficients (bool fromFifo)
+    void loadCoefficients (bool fromMailbox)
     {
-        if (fromFifo)
+        if (fromMailbox)
         {
-            if (coefficientsFifo.getNumAvailableForReading() > 0)
+            FifoDataType coefficients;
+            if (coefficientsMailbox.read (coefficients))
             {
-                FifoDataType coefficients;
-                discardOldCoefficientsIfAny();
-                auto success = coefficientsFifo.pull (coefficients);
-                jassert (success);
-                updateCoefficients (coefficients);
+                setRecord (coefficients);
             }
         }
         else
         {
             FifoDataType coefficients = FunctionType::make (currentParams);
-            updateCoefficients (coefficients);
+            requestedParams = currentParams;
+            setRecord (coefficients);
         }
     }
 
     void generateNewCoefficientsIfNeeded()
     {
+        auto smoothing = isSmoothing();
         if (shouldComputeNewCoefficients.compareAndSetBool (false, true))
         {
-            ParamType params;
-
-            params = currentParams;
-            params.frequency = freqSmoother.getNextValue();
-            params.quality = qualitySmoother.getNextValue();
-            if constexpr (! IsCutParameter<ParamType>::value)
-            {
-                params.gain = gainSmoother.getNextValue().getGain();
-            }
-
-            coefficientsGenerator.changeParameters (params);
+            submitParameters (getSmoothedParameterValues (true), smoothing);
         }
     }
 
@@ -198,22 +183,42 @@ struct FilterLink
         updateSmootherTargets();
     }
 
-    void performInnerLoopFilterUpdate (bool onRealTimeThread, int numSamplesToSkip)
+    /*
+     with 'interpolateCoefficients', the smoothers are advanced first and the parameters
+     published for the chunk are the ones at its end: the chain ramps its coefficients
+     towards them sample by sample instead of jumping at the start of the chunk.
+     */
+    void performInnerLoopFilterUpdate (bool onRealTimeThread, int numSamplesToSkip, bool interpolateCoefficients = false)
     {
         if (currentParams.bypassed)
         {
             return;
         }
 
-        generateNewCoefficientsIfNeeded();
-        loadCoefficients (onRealTimeThread);
-        advanceSmoothers (numSamplesToSkip);
+        if (interpolateCoefficients)
+        {
+            auto smoothing = isSmoothing();
+            advanceSmoothers (numSamplesToSkip);
+            if (shouldComputeNewCoefficients.compareAndSetBool (false, true))
+            {
+                submitParameters (getSmoothedParameterValues (false), smoothing);
+            }
+            loadCoefficients (onRealTimeThread);
+        }
+        else
+        {
+            generateNewCoefficientsIfNeeded();
+            loadCoefficients (onRealTimeThread);
+            advanceSmoothers (numSamplesToSkip);
+        }
+
         checkIfStillSmoothing();
     }
 
     void initialize (const ParamType& params, float rampTime, bool onRealTimeThread, double sr)
     {
         sampleRate = sr;
+        activityChanged = true;
         updateParams (params);
         resetSmoothers (rampTime);
         loadCoefficients (onRealTimeThread);
@@ -221,21 +226,12 @@ struct FilterLink
 
     double getCutFilterMagnitudeForFrequency (double frequency)
     {
-        double mag { 1 };
-        mag *= filter.template isBypassed<0>() ? 1.0
-                                               : filter.template get<0>().coefficients->getMagnitudeForFrequency (frequency, sampleRate);
-        mag *= filter.template isBypassed<1>() ? 1.0
-                                               : filter.template get<1>().coefficients->getMagnitudeForFrequency (frequency, sampleRate);
-        mag *= filter.template isBypassed<2>() ? 1.0
-                                               : filter.template get<2>().coefficients->getMagnitudeForFrequency (frequency, sampleRate);
-        mag *= filter.template isBypassed<3>() ? 1.0
-                                               : filter.template get<3>().coefficients->getMagnitudeForFrequency (frequency, sampleRate);
-        return mag;
+        return record.getMagnitudeForFrequency (frequency, sampleRate);
     }
 
     double getParametricFilterMagnitudeForFrequency (double frequency)
     {
-        return filter.coefficients->getMagnitudeForFrequency (frequency, sampleRate);
+        return record.getMagnitudeForFrequency (frequency, sampleRate);
     }
 
     bool isBypassed() const
@@ -243,91 +239,160 @@ struct FilterLink
         return currentParams.bypassed;
     }
 
-private:
-    static const size_t FIFO_SIZE = 2000;
-
-    void discardOldCoefficientsIfAny()
+    /*
+     a link is active when it's not bypassed and it's not an identity,
+     i.e. a peak or shelf band sitting at 0 dB once its gain ramp is over.
+     inactive links neither filter nor need coefficient updates.
+     */
+    bool isActive() const
     {
-        while (coefficientsFifo.getNumAvailableForReading() > 1)
+        if (currentParams.bypassed)
         {
-            FifoDataType unusedCoefficients;
-            if (coefficientsFifo.pull (unusedCoefficients))
-            {
-                if constexpr (IsCutFilter<FilterType>::value)
-                {
-                    for (auto& coefficient : unusedCoefficients)
-                    {
-                        coefficientsReleasePool.add (coefficient);
-                    }
-                }
-                else if constexpr (IsParametricFilter<FilterType>::value)
-                {
-                    coefficientsReleasePool.add (*unusedCoefficients);
-                }
-                else
-                {
-                    jassertfalse; //unknown filter type
-                }
-            }
-            else
+            return false;
+        }
+
+        if constexpr (! IsCutParameter<ParamType>::value)
+        {
+            if (isIdentityType (currentParams.type) && currentParams.gain == Decibel<float> (0.0f) && ! gainSmoother.isSmoothing())
             {
-                jassertfalse; // coefficientsFifo is inconsistent
+                return false;
             }
         }
+
+        return true;
+    }
+
+    /*
+     returns true (once) when bypass, gain or type changed since the last call,
+     or when a ramp ended, i.e. whenever isActive() might have changed.
+     */
+    bool consumeActivityChange()
+    {
+        auto changed = activityChanged;
+        activityChanged = false;
+        return changed;
+    }
+
+    /*
+     copies the active sections into 'sections' and returns how many there are.
+     an inactive link has no sections.
+     */
+    size_t getSections (Sections& sections) const
+    {
+        if (! isActive())
+        {
+            return 0;
+        }
+
+        std::copy (record.sections.begin(), record.sections.begin() + static_cast<std::ptrdiff_t> (record.numSections), sections.begin());
+        return record.numSections;
+    }
+
+    /*
+     incremented every time new coefficients are loaded, so that whoever mirrors
+     the sections can tell when they need to be copied again.
+     */
+    int getCoefficientsVersion() const
+    {
+        return coefficientsVersion;
+    }
+
+    /*
+     while the link is smoothing, its intermediate parameters are not sent to the
+     coefficient generator. they're published here instead, and whoever mirrors the
+     sections computes them together with the other bands (see CoefficientsBatch).
+     the version is incremented every time new smoothed parameters are available.
+     */
+    const ParamType& getSmoothedParameters() const
+    {
+        return smoothedParams;
+    }
+
+    int getSmoothedParametersVersion() const
+    {
+        return smoothedParamsVersion;
     }
 
-    FifoDataType loadCoefficientsFromFifo()
+    // the parameters the link is heading to, ignoring any smoothing
+    const ParamType& getTargetParameters() const
     {
+        return currentParams;
     }
 
-    void updateFilterState (CoefficientsPtr& oldState, CoefficientsPtr newState)
+    /*
+     the parameters of the latest coefficients that were asked for, smoothed or not.
+     lets a chain running at another precision compute its own sections
+     whenever the coefficients or the smoothed parameters change.
+     */
+    const ParamType& getRequestedParameters() const
     {
-        coefficientsReleasePool.add (*newState);
-        *oldState = *newState;
+        return requestedParams;
     }
 
-    void configureCutFilterChain (const FifoDataType& coefficients)
+private:
+    ParamType getSmoothedParameterValues (bool advance)
     {
-        filter.template setBypassed<0> (true);
-        filter.template setBypassed<1> (true);
-        filter.template setBypassed<2> (true);
-        filter.template setBypassed<3> (true);
+        ParamType params = currentParams;
+        params.frequency = advance ? freqSmoother.getNextValue() : freqSmoother.getCurrentValue();
+        params.quality = advance ? qualitySmoother.getNextValue() : qualitySmoother.getCurrentValue();
+        if constexpr (! IsCutParameter<ParamType>::value)
+        {
+            params.gain = advance ? gainSmoother.getNextValue() : gainSmoother.getCurrentValue();
+        }
+        return params;
+    }
 
-        switch (coefficients.size())
+    void submitParameters (const ParamType& params, bool smoothing)
+    {
+        requestedParams = params;
+        if (smoothing)
         {
-            case 4:
-            {
-                updateFilterState (filter.template get<3>().coefficients, coefficients[3]);
-                filter.template setBypassed<3> (false);
-            }
-            case 3:
-            {
-                updateFilterState (filter.template get<2>().coefficients, coefficients[2]);
-                filter.template setBypassed<2> (false);
-            }
-            case 2:
-            {
-                updateFilterState (filter.template get<1>().coefficients, coefficients[1]);
-                filter.template setBypassed<1> (false);
-            }
-            case 1:
-            {
-                updateFilterState (filter.template get<0>().coefficients, coefficients[0]);
-                filter.template setBypassed<0> (false);
-            }
+            // ramps are computed on the audio thread, batched with every other smoothing band
+            smoothedParams = params;
+            ++smoothedParamsVersion;
         }
+        else
+        {
+            coefficientsGenerator.changeParameters (params);
+        }
+    }
+
+    bool affectsActivity (const ParamType& params) const
+    {
+        if (params.bypassed != currentParams.bypassed)
+        {
+            return true;
+        }
+
+        if constexpr (! IsCutParameter<ParamType>::value)
+        {
+            return params.type != currentParams.type || params.gain != currentParams.gain;
+        }
+
+        return false;
+    }
+
+    static bool isIdentityType (FilterInfo::FilterType type)
+    {
+        return type == FilterInfo::FilterType::PEAKFILTER || type == FilterInfo::FilterType::LOWSHELF
+               || type == FilterInfo::FilterType::HIGHSHELF;
     }
 
-    FilterType filter;
+    FifoDataType record;
     ParamType currentParams;
-    Fifo<FifoDataType, FIFO_SIZE> coefficientsFifo;
-    FilterCoefficientGenerator<FifoDataType, ParamType, FunctionType, FIFO_SIZE> coefficientsGenerator { coefficientsFifo };
-    ReleasePool<Coefficients> coefficientsReleasePool;
+    ParamType smoothedParams;
+    ParamType requestedParams;
+    Mailbox<FifoDataType> coefficientsMailbox;
+    FilterCoefficientGenerator<FifoDataType, ParamType, FunctionType> coefficientsGenerator { coefficientsMailbox };
 
     juce::SmoothedValue<float> freqSmoother;
     juce::SmoothedValue<float> qualitySmoother;
     juce::SmoothedValue<Decibel<float>> gainSmoother;
 
     juce::Atomic<bool> shouldComputeNewCoefficients { false };
+    int coefficientsVersion = 0;
+    int smoothedParamsVersion = 0;
+    bool activityChanged = true;
+    bool wasSmoothing = false;
     double sampleRate;
 };
@@ -8,13 +8,6 @@ ResponseCurveComponent::ResponseCurveComponent (EqualizerAudioProcessor& p) : au
 {
     auto bindFunc = [this] { refreshParams(); };
     allParamsListener = std::make_unique<AllParamsListener> (apvts, bindFunc);
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = 1024;
-    spec.numChannels = 1;
-
-    leftChain.prepare (spec);
-    rightChain.prepare (spec);
 }
 
 void ResponseCurveComponent::paint (juce::Graphics& g)
@@ -74,7 +67,7 @@ void ResponseCurveComponent::buildNewResponseCurves()
 }
 void ResponseCurveComponent::updateChainParameters()
 {
-    ChainHelpers::initializeChains (leftChain, rightChain, sampleRate, *apvts);
+    ChainHelpers::initializeChains (leftChain, rightChain, sampleRate, audioProcessor.getParameterTable());
 }
 
 void ResponseCurveComponent::buildNewResponseCurve (std::vector<float>& path, ChainHelpers::MonoChain& chain)
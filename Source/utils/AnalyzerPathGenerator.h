@@ -19,6 +19,12 @@ struct AnalyzerPathGenerator
     int getNumPathsAvailable() const;
     bool getPath (juce::Path& path);
 
+    size_t getMemoryFootprint() const
+    {
+        return pathFifo.getMemoryFootprint();
+    }
+
 private:
-    Fifo<juce::Path, 50> pathFifo;
+    // the editor drains every path at each frame and only draws the last one
+    Fifo<juce::Path, 8> pathFifo;
 };
@@ -0,0 +1,434 @@
+#pragma once
+
+#include "utils/BiquadSection.h"
+#include <JuceHeader.h>
+
+/*
+ runs a cascade of biquad sections over NumLanes channels in lockstep.
+ coefficients and state of every section are stored in juce::dsp::SIMDRegisters,
+ one lane per channel, and the sample by sample kernel computes whole registers.
+ the lanes a register has beyond NumLanes (the two spare lanes of a stereo float
+ register) run identity sections on zeros.
+
+ sections live in fixed slots: the state of a slot survives coefficient
+ updates and changes of the active slot list, the same way
+ juce::dsp::IIR::Filter keeps its state when its coefficients are replaced.
+
+ a cascade is latency bound when processed sample by sample: every section waits
+ for the output of the one before. the pipelined kernel puts PIPELINE_DEPTH
+ consecutive sections of one channel in PIPELINE_DEPTH lanes instead, lane k
+ working on the sample k steps behind lane 0. the lanes are independent from
+ each other within a step, so a group costs about one vector biquad per sample.
+ the pipeline is filled and drained within every block, so there's no latency.
+
+ coefficients either jump to a new set (setCoefficients) or ramp linearly
+ towards it, sample by sample (setTargetCoefficients). the set of stable
+ biquads is convex in (a1, a2), so every intermediate set between two stable
+ endpoints is stable as well.
+ */
+template <typename FloatType, size_t NumLanes, size_t NumSlots>
+struct BiquadLaneCascade
+{
+    static constexpr size_t ALIGNMENT = 32;
+    static constexpr size_t PIPELINE_DEPTH = 4;
+
+    void reset()
+    {
+        for (auto& slot : slots)
+        {
+            slot.s1 = makeLanes (FloatType (0));
+            slot.s2 = makeLanes (FloatType (0));
+        }
+    }
+
+    void setCoefficients (size_t slotIndex, size_t lane, const BiquadSection<FloatType>& section)
+    {
+        jassert (slotIndex < NumSlots && lane < NumLanes);
+        auto& slot = slots[slotIndex];
+        slot.target[lane] = section;
+        for (size_t c = 0; c < NUM_COEFFICIENTS; ++c)
+        {
+            setLane (slot.coefficients[c], lane, getCoefficient (section, c));
+            setLane (slot.steps[c], lane, FloatType (0));
+        }
+    }
+
+    /*
+     ramps the coefficients of 'lane' from their current values to 'section' over
+     the next 'rampLength' processed samples. the other lanes of the slot keep
+     heading to their own targets, over the same number of samples.
+     */
+    void setTargetCoefficients (size_t slotIndex, size_t lane, const BiquadSection<FloatType>& section, size_t rampLength)
+    {
+        jassert (slotIndex < NumSlots && lane < NumLanes);
+        if (rampLength == 0)
+        {
+            setCoefficients (slotIndex, lane, section);
+            return;
+        }
+
+        auto& slot = slots[slotIndex];
+        slot.target[lane] = section;
+        slot.rampSamplesLeft = rampLength;
+
+        auto rampLengthInv = FloatType (1) / static_cast<FloatType> (rampLength);
+        for (size_t l = 0; l < NumLanes; ++l)
+        {
+            for (size_t c = 0; c < NUM_COEFFICIENTS; ++c)
+            {
+                setLane (slot.steps[c], l, (getCoefficient (slot.target[l], c) - getLane (slot.coefficients[c], l)) * rampLengthInv);
+            }
+        }
+    }
+
+    // the coefficients the slot is heading to, or is at when it isn't ramping
+    const BiquadSection<FloatType>& getTargetCoefficients (size_t slotIndex, size_t lane) const
+    {
+        jassert (slotIndex < NumSlots && lane < NumLanes);
+        return slots[slotIndex].target[lane];
+    }
+
+    void getState (size_t slotIndex, size_t lane, FloatType& s1, FloatType& s2) const
+    {
+        jassert (slotIndex < NumSlots && lane < NumLanes);
+        s1 = getLane (slots[slotIndex].s1, lane);
+        s2 = getLane (slots[slotIndex].s2, lane);
+    }
+
+    void setState (size_t slotIndex, size_t lane, FloatType s1, FloatType s2)
+    {
+        jassert (slotIndex < NumSlots && lane < NumLanes);
+        setLane (slots[slotIndex].s1, lane, s1);
+        setLane (slots[slotIndex].s2, lane, s2);
+    }
+
+    void setActiveSlots (const std::array<size_t, NumSlots>& slotIndices, size_t numSlots)
+    {
+        jassert (numSlots <= NumSlots);
+        activeSlots = slotIndices;
+        numActiveSlots = numSlots;
+    }
+
+    size_t getNumActiveSlots() const
+    {
+        return numActiveSlots;
+    }
+
+    /*
+     the active slots are processed in groups of PIPELINE_DEPTH, each group over the
+     whole block before the next one. a group whose coefficients are steady runs
+     through the pipelined kernel, one channel at a time; ramping groups and the
+     remainder run sample by sample with one lane per channel.
+     */
+    void process (FloatType* const* channels, size_t numSamples) noexcept
+    {
+        if (numActiveSlots == 0)
+        {
+            return;
+        }
+
+        for (size_t first = 0; first < numActiveSlots; first += PIPELINE_DEPTH)
+        {
+            auto groupSize = juce::jmin (PIPELINE_DEPTH, numActiveSlots - first);
+            if (groupSize == PIPELINE_DEPTH && numSamples >= PIPELINE_DEPTH && ! isAnySlotRamping (first, groupSize))
+            {
+                for (size_t lane = 0; lane < NumLanes; ++lane)
+                {
+                    processPipelined (first, lane, channels[lane], numSamples);
+                }
+            }
+            else
+            {
+                processInterleaved (first, groupSize, channels, numSamples);
+            }
+        }
+
+        for (size_t n = 0; n < numActiveSlots; ++n)
+        {
+            snapToZero (slots[activeSlots[n]]);
+        }
+    }
+
+private:
+    using Vector = juce::dsp::SIMDRegister<FloatType>;
+    static constexpr size_t LANES_PER_VECTOR = Vector::SIMDNumElements;
+    static constexpr size_t NUM_VECTORS = (NumLanes + LANES_PER_VECTOR - 1) / LANES_PER_VECTOR;
+    // lane l is element l % LANES_PER_VECTOR of vector l / LANES_PER_VECTOR
+    using LaneArray = std::array<Vector, NUM_VECTORS>;
+
+    enum Coefficient
+    {
+        B0,
+        B1,
+        B2,
+        A1,
+        A2,
+        NUM_COEFFICIENTS
+    };
+
+    struct alignas (ALIGNMENT) Slot
+    {
+        std::array<LaneArray, NUM_COEFFICIENTS> coefficients = makeIdentity();
+        std::array<LaneArray, NUM_COEFFICIENTS> steps {};
+        LaneArray s1 = makeLanes (FloatType (0));
+        LaneArray s2 = makeLanes (FloatType (0));
+        std::array<BiquadSection<FloatType>, NumLanes> target {};
+        size_t rampSamplesLeft = 0;
+    };
+
+    static LaneArray makeLanes (FloatType value)
+    {
+        LaneArray lanes;
+        lanes.fill (Vector::expand (value));
+        return lanes;
+    }
+
+    static FloatType getLane (const LaneArray& lanes, size_t lane) noexcept
+    {
+        return lanes[lane / LANES_PER_VECTOR].get (lane % LANES_PER_VECTOR);
+    }
+
+    static void setLane (LaneArray& lanes, size_t lane, FloatType value) noexcept
+    {
+        lanes[lane / LANES_PER_VECTOR].set (lane % LANES_PER_VECTOR, value);
+    }
+
+    static std::array<LaneArray, NUM_COEFFICIENTS> makeIdentity()
+    {
+        std::array<LaneArray, NUM_COEFFICIENTS> identity;
+        for (size_t c = 0; c < NUM_COEFFICIENTS; ++c)
+        {
+            identity[c] = makeLanes (getCoefficient (BiquadSection<FloatType>::identity(), c));
+        }
+        return identity;
+    }
+
+    static FloatType getCoefficient (const BiquadSection<FloatType>& section, size_t index)
+    {
+        switch (index)
+        {
+            case B0:
+                return section.b0;
+            case B1:
+                return section.b1;
+            case B2:
+                return section.b2;
+            case A1:
+                return section.a1;
+            case A2:
+                return section.a2;
+            default:
+                jassertfalse;
+                return FloatType (0);
+        }
+    }
+
+    static void advanceRamp (Slot& slot) noexcept
+    {
+        if (--slot.rampSamplesLeft == 0)
+        {
+            // land exactly on the targets, whatever rounding the steps accumulated
+            for (size_t lane = 0; lane < NumLanes; ++lane)
+            {
+                for (size_t c = 0; c < NUM_COEFFICIENTS; ++c)
+                {
+                    setLane (slot.coefficients[c], lane, getCoefficient (slot.target[lane], c));
+                    setLane (slot.steps[c], lane, FloatType (0));
+                }
+            }
+            return;
+        }
+
+        for (size_t c = 0; c < NUM_COEFFICIENTS; ++c)
+        {
+            for (size_t v = 0; v < NUM_VECTORS; ++v)
+            {
+                slot.coefficients[c][v] += slot.steps[c][v];
+            }
+        }
+    }
+
+    static void processSample (Slot& slot, LaneArray& x) noexcept
+    {
+        const auto& b0 = slot.coefficients[B0];
+        const auto& b1 = slot.coefficients[B1];
+        const auto& b2 = slot.coefficients[B2];
+        const auto& a1 = slot.coefficients[A1];
+        const auto& a2 = slot.coefficients[A2];
+
+        for (size_t v = 0; v < NUM_VECTORS; ++v)
+        {
+            auto input = x[v];
+            auto output = b0[v] * input + slot.s1[v];
+            slot.s1[v] = b1[v] * input - a1[v] * output + slot.s2[v];
+            slot.s2[v] = b2[v] * input - a2[v] * output;
+            x[v] = output;
+        }
+    }
+
+    bool isAnySlotRamping (size_t first, size_t groupSize) const noexcept
+    {
+        for (size_t n = first; n < first + groupSize; ++n)
+        {
+            if (slots[activeSlots[n]].rampSamplesLeft > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void processInterleaved (size_t first, size_t groupSize, FloatType* const* channels, size_t numSamples) noexcept
+    {
+        // the spare lanes stay at zero
+        auto x = makeLanes (FloatType (0));
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            for (size_t lane = 0; lane < NumLanes; ++lane)
+            {
+                setLane (x, lane, channels[lane][i]);
+            }
+
+            for (size_t n = first; n < first + groupSize; ++n)
+            {
+                auto& slot = slots[activeSlots[n]];
+                if (slot.rampSamplesLeft > 0)
+                {
+                    advanceRamp (slot);
+                }
+                processSample (slot, x);
+            }
+
+            for (size_t lane = 0; lane < NumLanes; ++lane)
+            {
+                channels[lane][i] = getLane (x, lane);
+            }
+        }
+    }
+
+    using PipelineArray = std::array<FloatType, PIPELINE_DEPTH>;
+
+    // one channel of PIPELINE_DEPTH consecutive slots, with the sections side by side
+    struct alignas (ALIGNMENT) Pipeline
+    {
+        std::array<PipelineArray, NUM_COEFFICIENTS> coefficients;
+        PipelineArray s1, s2;
+        // the latest output of every stage, i.e. the input of the next one
+        PipelineArray y {};
+
+        // runs the stages from 'last' down to 'first', so that every stage still reads the previous output of the one before
+        void stepPartial (size_t first, size_t last, FloatType input) noexcept
+        {
+            for (size_t k = last + 1; k-- > first;)
+            {
+                auto x = k == 0 ? input : y[k - 1];
+                auto output = coefficients[B0][k] * x + s1[k];
+                s1[k] = coefficients[B1][k] * x - coefficients[A1][k] * output + s2[k];
+                s2[k] = coefficients[B2][k] * x - coefficients[A2][k] * output;
+                y[k] = output;
+            }
+        }
+
+        /*
+         the steady state: every stage busy, the last one emits the sample that entered
+         PIPELINE_DEPTH - 1 steps before. the state is kept in locals and every statement
+         of the biquad is its own loop over the stages, which is the shape the compilers
+         turn into whole-register operations (keeping the members and one fused loop
+         leaves GCC with scalar code).
+         */
+        void run (FloatType* data, size_t begin, size_t end) noexcept
+        {
+            const auto lastStage = PIPELINE_DEPTH - 1;
+            const auto b0 = coefficients[B0], b1 = coefficients[B1], b2 = coefficients[B2];
+            const auto a1 = coefficients[A1], a2 = coefficients[A2];
+            auto state1 = s1, state2 = s2, output = y;
+
+            for (size_t t = begin; t < end; ++t)
+            {
+                PipelineArray x;
+                x[0] = data[t];
+                for (size_t k = 1; k < PIPELINE_DEPTH; ++k)
+                {
+                    x[k] = output[k - 1];
+                }
+
+                for (size_t k = 0; k < PIPELINE_DEPTH; ++k)
+                {
+                    output[k] = b0[k] * x[k] + state1[k];
+                }
+                for (size_t k = 0; k < PIPELINE_DEPTH; ++k)
+                {
+                    state1[k] = b1[k] * x[k] - a1[k] * output[k] + state2[k];
+                }
+                for (size_t k = 0; k < PIPELINE_DEPTH; ++k)
+                {
+                    state2[k] = b2[k] * x[k] - a2[k] * output[k];
+                }
+
+                data[t - lastStage] = output[lastStage];
+            }
+
+            s1 = state1;
+            s2 = state2;
+            y = output;
+        }
+    };
+
+    void processPipelined (size_t first, size_t lane, FloatType* data, size_t numSamples) noexcept
+    {
+        jassert (numSamples >= PIPELINE_DEPTH);
+        const auto lastStage = PIPELINE_DEPTH - 1;
+
+        Pipeline pipeline;
+        for (size_t k = 0; k < PIPELINE_DEPTH; ++k)
+        {
+            const auto& slot = slots[activeSlots[first + k]];
+            for (size_t c = 0; c < NUM_COEFFICIENTS; ++c)
+            {
+                pipeline.coefficients[c][k] = getLane (slot.coefficients[c], lane);
+            }
+            pipeline.s1[k] = getLane (slot.s1, lane);
+            pipeline.s2[k] = getLane (slot.s2, lane);
+        }
+
+        // fill: stage k starts at step k
+        for (size_t t = 0; t < lastStage; ++t)
+        {
+            pipeline.stepPartial (0, t, data[t]);
+        }
+
+        pipeline.run (data, lastStage, numSamples);
+
+        // drain: stage k stops once it has seen the last sample
+        for (size_t t = numSamples; t < numSamples + lastStage; ++t)
+        {
+            pipeline.stepPartial (t - numSamples + 1, lastStage, FloatType (0));
+            data[t - lastStage] = pipeline.y[lastStage];
+        }
+
+        for (size_t k = 0; k < PIPELINE_DEPTH; ++k)
+        {
+            auto& slot = slots[activeSlots[first + k]];
+            setLane (slot.s1, lane, pipeline.s1[k]);
+            setLane (slot.s2, lane, pipeline.s2[k]);
+        }
+    }
+
+    static void snapToZero (Slot& slot) noexcept
+    {
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            auto s1 = getLane (slot.s1, lane);
+            auto s2 = getLane (slot.s2, lane);
+            juce::dsp::util::snapToZero (s1);
+            juce::dsp::util::snapToZero (s2);
+            setLane (slot.s1, lane, s1);
+            setLane (slot.s2, lane, s2);
+        }
+    }
+
+    std::array<Slot, NumSlots> slots;
+    std::array<size_t, NumSlots> activeSlots {};
+    size_t numActiveSlots = 0;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ normalised (a0 == 1) transposed direct form II biquad coefficients.
+ first order sections are stored as biquads with b2 == a2 == 0.
+ */
+template <typename FloatType>
+struct BiquadSection
+{
+    FloatType b0 = FloatType (1);
+    FloatType b1 = FloatType (0);
+    FloatType b2 = FloatType (0);
+    FloatType a1 = FloatType (0);
+    FloatType a2 = FloatType (0);
+
+    static BiquadSection identity()
+    {
+        return {};
+    }
+
+    /*
+     |H (e^jw)|, from the squared magnitudes of numerator and denominator:
+     |b0 + b1 z^-1 + b2 z^-2|^2 = b0^2 + b1^2 + b2^2 + 2 (b0 b1 + b1 b2) cos w + 2 b0 b2 cos 2w
+     */
+    double getMagnitudeForFrequency (double frequency, double sampleRate) const
+    {
+        auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        auto cosW = std::cos (w);
+        auto cos2W = 2.0 * cosW * cosW - 1.0;
+
+        auto squaredMagnitude = [cosW, cos2W] (double c0, double c1, double c2)
+        { return c0 * c0 + c1 * c1 + c2 * c2 + 2.0 * (c0 * c1 + c1 * c2) * cosW + 2.0 * c0 * c2 * cos2W; };
+
+        auto numerator = squaredMagnitude (static_cast<double> (b0), static_cast<double> (b1), static_cast<double> (b2));
+        auto denominator = squaredMagnitude (1.0, static_cast<double> (a1), static_cast<double> (a2));
+        return std::sqrt (juce::jmax (0.0, numerator) / denominator);
+    }
+
+    template <typename OtherFloatType>
+    static BiquadSection fromSection (const BiquadSection<OtherFloatType>& other)
+    {
+        return { static_cast<FloatType> (other.b0),
+                 static_cast<FloatType> (other.b1),
+                 static_cast<FloatType> (other.b2),
+                 static_cast<FloatType> (other.a1),
+                 static_cast<FloatType> (other.a2) };
+    }
+
+    template <typename CoefficientType>
+    static BiquadSection fromCoefficients (const juce::dsp::IIR::Coefficients<CoefficientType>& coefficients)
+    {
+        BiquadSection section;
+        auto raw = coefficients.coefficients.begin();
+
+        switch (coefficients.coefficients.size())
+        {
+            case 5:
+                section.b0 = static_cast<FloatType> (raw[0]);
+                section.b1 = static_cast<FloatType> (raw[1]);
+                section.b2 = static_cast<FloatType> (raw[2]);
+                section.a1 = static_cast<FloatType> (raw[3]);
+                section.a2 = static_cast<FloatType> (raw[4]);
+                break;
+            case 3:
+                section.b0 = static_cast<FloatType> (raw[0]);
+                section.b1 = static_cast<FloatType> (raw[1]);
+                section.a1 = static_cast<FloatType> (raw[2]);
+                break;
+            default:
+                jassertfalse; // only first and second order sections are supported
+                break;
+        }
+
+        return section;
+    }
+};
@@ -2,11 +2,13 @@
 
 #include "data/FilterLink.h"
 #include "data/FilterParameters.h"
-#include "utils/CoefficientsMaker.h"
 #include "utils/EqParam.h"
 #include "utils/FilterParam.h"
 #include "utils/FilterType.h"
+#include "utils/ParameterTable.h"
+#include "utils/SectionRecord.h"
 #include <JuceHeader.h>
+#include <tuple>
 
 #define RAMP_TIME_IN_SECONDS 0.05f
 
@@ -24,38 +26,54 @@ enum class ChainPositions
 
 namespace ChainHelpers
 {
-using Filter = juce::dsp::IIR::Filter<float>;
-using Coefficients = juce::dsp::IIR::Coefficients<float>;
-using CoefficientsPtr = Coefficients::Ptr;
-using CutCoefficients = juce::ReferenceCountedArray<Coefficients>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-
-using CutFilterLink = FilterLink<CutFilter, CutCoefficients, HighCutLowCutParameters, CoefficientsMaker<float>>;
-using SingleFilterLink = FilterLink<Filter, CoefficientsPtr, FilterParameters, CoefficientsMaker<float>>;
-
-using MonoChain = juce::dsp::ProcessorChain<CutFilterLink,    //lowCut
-                                            SingleFilterLink, //lowShelf
-                                            SingleFilterLink, //Peak1
-                                            SingleFilterLink, //Peak2
-                                            SingleFilterLink, //Peak3
-                                            SingleFilterLink, //Peak4
-                                            SingleFilterLink, //HighShelf
-                                            CutFilterLink>;   //HighCut
+using CutCoefficients = SectionRecord<4>;
+using Coefficients = SectionRecord<1>;
+
+using CutFilterLink = FilterLink<CutCoefficients, HighCutLowCutParameters, SectionRecordMaker>;
+using SingleFilterLink = FilterLink<Coefficients, FilterParameters, SectionRecordMaker>;
+
+// the links of a channel in chain order, get<Index>() as in a juce::dsp::ProcessorChain
+template <typename... Links>
+struct LinkChain
+{
+    template <int Index>
+    auto& get() noexcept
+    {
+        return std::get<Index> (links);
+    }
+
+    template <int Index>
+    const auto& get() const noexcept
+    {
+        return std::get<Index> (links);
+    }
+
+private:
+    std::tuple<Links...> links;
+};
+
+using MonoChain = LinkChain<CutFilterLink,    //lowCut
+                            SingleFilterLink, //lowShelf
+                            SingleFilterLink, //Peak1
+                            SingleFilterLink, //Peak2
+                            SingleFilterLink, //Peak3
+                            SingleFilterLink, //Peak4
+                            SingleFilterLink, //HighShelf
+                            CutFilterLink>;   //HighCut
 
 template <int FilterIndex>
-float getRawFilterParameter (Channel audioChannel, FilterInfo::FilterParam filterParameter, juce::AudioProcessorValueTreeState& apvts)
+float getRawFilterParameter (Channel audioChannel, FilterInfo::FilterParam filterParameter, const ParameterTable& parameters)
 {
-    auto name = FilterInfo::getParameterName (FilterIndex, audioChannel, filterParameter);
-    return apvts.getRawParameterValue (name)->load();
+    return parameters.getFilterParameter (FilterIndex, audioChannel, filterParameter);
 }
 
 template <int FilterIndex>
-FilterParametersBase getBaseParameters (Channel audioChannel, double sampleRate, juce::AudioProcessorValueTreeState& apvts)
+FilterParametersBase getBaseParameters (Channel audioChannel, double sampleRate, const ParameterTable& parameters)
 {
-    auto frequencyParam = getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::FREQUENCY, apvts);
-    auto bypassParamRaw = getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::BYPASS, apvts);
+    auto frequencyParam = getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::FREQUENCY, parameters);
+    auto bypassParamRaw = getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::BYPASS, parameters);
     auto bypassParam = bypassParamRaw > 0.5f;
-    auto qParam = getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::Q, apvts);
+    auto qParam = getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::Q, parameters);
 
     return FilterParametersBase { frequencyParam, bypassParam, qParam, sampleRate };
 }
@@ -64,21 +82,21 @@ template <int FilterIndex>
 FilterParameters getParametricParameters (Channel audioChannel,
                                           FilterInfo::FilterType filterType,
                                           double sampleRate,
-                                          juce::AudioProcessorValueTreeState& apvts)
+                                          const ParameterTable& parameters)
 {
-    auto baseParams = getBaseParameters<FilterIndex> (audioChannel, sampleRate, apvts);
-    auto gainParam = Decibel<float> (getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::GAIN, apvts));
+    auto baseParams = getBaseParameters<FilterIndex> (audioChannel, sampleRate, parameters);
+    auto gainParam = Decibel<float> (getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::GAIN, parameters));
 
     return FilterParameters { baseParams, filterType, gainParam };
 }
 
 template <int FilterIndex>
 HighCutLowCutParameters
-    getCutParameters (Channel audioChannel, FilterInfo::FilterType filterType, double sampleRate, juce::AudioProcessorValueTreeState& apvts)
+    getCutParameters (Channel audioChannel, FilterInfo::FilterType filterType, double sampleRate, const ParameterTable& parameters)
 {
-    auto baseParams = getBaseParameters<FilterIndex> (audioChannel, sampleRate, apvts);
+    auto baseParams = getBaseParameters<FilterIndex> (audioChannel, sampleRate, parameters);
     auto isLowCutParam = filterType == FilterInfo::FilterType::HIGHPASS;
-    auto slopeParam = static_cast<int> (getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::SLOPE, apvts));
+    auto slopeParam = static_cast<int> (getRawFilterParameter<FilterIndex> (audioChannel, FilterInfo::FilterParam::SLOPE, parameters));
 
     return HighCutLowCutParameters { baseParams, slopeParam, isLowCutParam };
 }
@@ -90,14 +108,14 @@ void initializeCutFilter (MonoChain& leftChain,
                           EqMode mode,
                           bool onRealTimeThread,
                           double sampleRate,
-                          juce::AudioProcessorValueTreeState& apvts)
+                          const ParameterTable& parameters)
 {
     const int FilterIndex = static_cast<int> (FilterPosition);
-    auto leftCutParams = getCutParameters<FilterIndex> (Channel::LEFT, filterType, sampleRate, apvts);
+    auto leftCutParams = getCutParameters<FilterIndex> (Channel::LEFT, filterType, sampleRate, parameters);
     leftChain.get<FilterIndex>().initialize (leftCutParams, RAMP_TIME_IN_SECONDS, onRealTimeThread, sampleRate);
 
     auto rightCutParams = mode == EqMode::STEREO ? leftCutParams //
-                                                 : getCutParameters<FilterIndex> (Channel::RIGHT, filterType, sampleRate, apvts);
+                                                 : getCutParameters<FilterIndex> (Channel::RIGHT, filterType, sampleRate, parameters);
     rightChain.get<FilterIndex>().initialize (rightCutParams, RAMP_TIME_IN_SECONDS, onRealTimeThread, sampleRate);
 }
 
@@ -108,81 +126,78 @@ void initializeParametricFilter (MonoChain& leftChain,
                                  EqMode mode,
                                  bool onRealTimeThread,
                                  double sampleRate,
-                                 juce::AudioProcessorValueTreeState& apvts)
+                                 const ParameterTable& parameters)
 {
     const int FilterIndex = static_cast<int> (FilterPosition);
-    auto leftParametricParams = getParametricParameters<FilterIndex> (Channel::LEFT, filterType, sampleRate, apvts);
+    auto leftParametricParams = getParametricParameters<FilterIndex> (Channel::LEFT, filterType, sampleRate, parameters);
     leftChain.get<FilterIndex>().initialize (leftParametricParams, RAMP_TIME_IN_SECONDS, onRealTimeThread, sampleRate);
 
     auto rightParametricParams = mode == EqMode::STEREO
                                      ? leftParametricParams
-                                     : getParametricParameters<FilterIndex> (Channel::RIGHT, filterType, sampleRate, apvts);
+                                     : getParametricParameters<FilterIndex> (Channel::RIGHT, filterType, sampleRate, parameters);
     rightChain.get<FilterIndex>().initialize (rightParametricParams, RAMP_TIME_IN_SECONDS, onRealTimeThread, sampleRate);
 }
 
-inline void initializeChains (MonoChain& leftChain, MonoChain& rightChain, double sampleRate, juce::AudioProcessorValueTreeState& apvts)
+inline void initializeChains (MonoChain& leftChain, MonoChain& rightChain, double sampleRate, const ParameterTable& parameters)
 {
     bool onRealTimeThread = ! juce::MessageManager::getInstanceWithoutCreating()->isThisTheMessageThread();
-    auto mode = static_cast<EqMode> (apvts.getRawParameterValue ("eq_mode")->load());
+    auto mode = parameters.getEqMode();
     initializeCutFilter<ChainPositions::LOWCUT> (leftChain,
                                                  rightChain,
                                                  FilterInfo::FilterType::HIGHPASS,
                                                  mode,
                                                  onRealTimeThread,
                                                  sampleRate,
-                                                 apvts);
+                                                 parameters);
     initializeParametricFilter<ChainPositions::LOWSHELF> (leftChain,
                                                           rightChain,
                                                           FilterInfo::FilterType::LOWSHELF,
                                                           mode,
                                                           onRealTimeThread,
                                                           sampleRate,
-                                                          apvts);
+                                                          parameters);
     initializeParametricFilter<ChainPositions::PEAK1> (leftChain,
                                                        rightChain,
                                                        FilterInfo::FilterType::PEAKFILTER,
                                                        mode,
                                                        onRealTimeThread,
                                                        sampleRate,
-                                                       apvts);
+                                                       parameters);
     initializeParametricFilter<ChainPositions::PEAK2> (leftChain,
                                                        rightChain,
                                                        FilterInfo::FilterType::PEAKFILTER,
                                                        mode,
                                                        onRealTimeThread,
                                                        sampleRate,
-                                                       apvts);
+                                                       parameters);
     initializeParametricFilter<ChainPositions::PEAK3> (leftChain,
                                                        rightChain,
                                                        FilterInfo::FilterType::PEAKFILTER,
                                                        mode,
                                                        onRealTimeThread,
                                                        sampleRate,
-                                                       apvts);
+                                                       parameters);
     initializeParametricFilter<ChainPositions::PEAK4> (leftChain,
                                                        rightChain,
                                                        FilterInfo::FilterType::PEAKFILTER,
                                                        mode,
                                                        onRealTimeThread,
                                                        sampleRate,
-                                                       apvts);
+                                                       parameters);
     initializeParametricFilter<ChainPositions::HIGHSHELF> (leftChain,
                                                            rightChain,
                                                            FilterInfo::FilterType::HIGHSHELF,
                                                            mode,
                                                            onRealTimeThread,
                                                            sampleRate,
-                                                           apvts);
+                                                           parameters);
     initializeCutFilter<ChainPositions::HIGHCUT> (leftChain,
                                                   rightChain,
                                                   FilterInfo::FilterType::LOWPASS,
                                                   mode,
                                                   onRealTimeThread,
                                                   sampleRate,
-                                                  apvts);
-
-    leftChain.reset();
-    rightChain.reset();
+                                                  parameters);
 }
 
 inline float getDefaultValueForParameter (ChainPositions position, FilterInfo::FilterParam filterParam)
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "utils/EqParam.h"
+#include <JuceHeader.h>
+
+/*
+ every channel of the bus is filtered by one of the two parameter sets, its group:
+ - in stereo mode every channel uses the left set (the right set mirrors it anyway),
+ - in mid/side mode the first two channels are mid (left set) and side (right set),
+ - otherwise, and for the remaining channels in mid/side mode, a channel follows
+   its "channel_group_<n>" parameter. "Auto" picks the set by the channel's position
+   in the layout: channels on the right side use the right set, everything else
+   (left side, centre, LFE) the left one. discrete channels alternate, pair by pair.
+ */
+namespace ChannelGroups
+{
+static const size_t MAX_CHANNELS = 16;
+
+enum class Assignment
+{
+    AUTO,
+    LEFT,
+    RIGHT
+};
+
+using Groups = std::array<Channel, MAX_CHANNELS>;
+using ChannelTypes = std::array<juce::AudioChannelSet::ChannelType, MAX_CHANNELS>;
+
+inline juce::String getParameterName (size_t channel)
+{
+    return "channel_group_" + juce::String (static_cast<int> (channel) + 1);
+}
+
+inline juce::StringArray getAssignmentNames()
+{
+    return { "Auto", "Left", "Right" };
+}
+
+inline Channel getAutoGroup (juce::AudioChannelSet::ChannelType type, size_t channel)
+{
+    switch (type)
+    {
+        case juce::AudioChannelSet::right:
+        case juce::AudioChannelSet::rightSurround:
+        case juce::AudioChannelSet::rightCentre:
+        case juce::AudioChannelSet::rightSurroundSide:
+        case juce::AudioChannelSet::rightSurroundRear:
+        case juce::AudioChannelSet::wideRight:
+        case juce::AudioChannelSet::topFrontRight:
+        case juce::AudioChannelSet::topRearRight:
+        case juce::AudioChannelSet::topSideRight:
+            return Channel::RIGHT;
+        default:
+            break;
+    }
+
+    if (type >= juce::AudioChannelSet::discreteChannel0 || type == juce::AudioChannelSet::unknown)
+    {
+        return channel % 2 == 0 ? Channel::LEFT : Channel::RIGHT;
+    }
+
+    return Channel::LEFT;
+}
+
+inline Channel getGroup (EqMode mode, Assignment assignment, juce::AudioChannelSet::ChannelType type, size_t channel)
+{
+    if (mode == EqMode::STEREO)
+    {
+        return Channel::LEFT;
+    }
+
+    if (mode == EqMode::MID_SIDE && channel < 2)
+    {
+        return channel == 0 ? Channel::LEFT : Channel::RIGHT;
+    }
+
+    switch (assignment)
+    {
+        case Assignment::LEFT:
+            return Channel::LEFT;
+        case Assignment::RIGHT:
+            return Channel::RIGHT;
+        case Assignment::AUTO:
+            break;
+    }
+
+    return getAutoGroup (type, channel);
+}
+
+inline ChannelTypes getChannelTypes (const juce::AudioChannelSet& layout)
+{
+    ChannelTypes types;
+    for (size_t channel = 0; channel < MAX_CHANNELS; ++channel)
+    {
+        types[channel] = layout.getTypeOfChannel (static_cast<int> (channel));
+    }
+    return types;
+}
+} // namespace ChannelGroups
@@ -0,0 +1,190 @@
+#include "utils/CoefficientWorkerPool.h"
+
+CoefficientWorkerPool::CoefficientWorkerPool()
+{
+    auto numWorkers = juce::jmax (1, juce::SystemStats::getNumCpus());
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back (std::make_unique<Worker> (*this, i));
+        workers.back()->startThread();
+    }
+}
+
+CoefficientWorkerPool::~CoefficientWorkerPool()
+{
+    for (auto& worker : workers)
+    {
+        worker->signalThreadShouldExit();
+    }
+
+    wakeWorkers (true);
+    for (auto& worker : workers)
+    {
+        worker->waitForThreadToExit (-1);
+    }
+}
+
+void CoefficientWorkerPool::schedule (Job& job)
+{
+    /*
+     what the caller wrote for the job (a Mailbox, a ring...) is ordered before the load of
+     its state. paired with the fence in runNextJob(): either this sees the job RUNNING and
+     reschedules it, or the worker's run() sees what was written.
+     */
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    retryPendingJobs();
+    auto state = job.state.load();
+
+    for (;;)
+    {
+        switch (state)
+        {
+            case IDLE:
+                if (job.state.compare_exchange_weak (state, QUEUED))
+                {
+                    if (jobs.push (&job))
+                    {
+                        wakeWorkers (false);
+                    }
+                    else
+                    {
+                        // the job stays QUEUED, the next worker to look at the queue pushes it again
+                        addPendingJob (job);
+                        wakeWorkers (false);
+                    }
+                    return;
+                }
+                break;
+            case RUNNING:
+                if (job.state.compare_exchange_weak (state, RUNNING_AND_RESCHEDULED))
+                {
+                    return;
+                }
+                break;
+            default:
+                // already queued, or already bound to run again
+                return;
+        }
+    }
+}
+
+void CoefficientWorkerPool::waitUntilIdle (Job& job)
+{
+    while (job.state.load() != IDLE)
+    {
+        juce::Thread::sleep (1);
+    }
+}
+
+int CoefficientWorkerPool::getNumWorkers() const
+{
+    return static_cast<int> (workers.size());
+}
+
+void CoefficientWorkerPool::wakeWorkers (bool all)
+{
+    workCounter.fetch_add (1);
+    if (all)
+    {
+        workCounter.notify_all();
+    }
+    else
+    {
+        workCounter.notify_one();
+    }
+}
+
+void CoefficientWorkerPool::addPendingJob (Job& job)
+{
+    // a job is in the list at most once, it's QUEUED, and the list is only ever taken whole: no ABA
+    job.nextPending = pendingJobs.load();
+    while (! pendingJobs.compare_exchange_weak (job.nextPending, &job))
+    {
+    }
+}
+
+void CoefficientWorkerPool::retryPendingJobs()
+{
+    if (pendingJobs.load (std::memory_order_relaxed) == nullptr)
+    {
+        return;
+    }
+
+    auto* job = pendingJobs.exchange (nullptr);
+    while (job != nullptr)
+    {
+        auto* next = job->nextPending;
+        if (jobs.push (job))
+        {
+            wakeWorkers (false);
+        }
+        else
+        {
+            addPendingJob (*job);
+        }
+        job = next;
+    }
+}
+
+bool CoefficientWorkerPool::runNextJob()
+{
+    // the last pop made room for the jobs that didn't fit
+    retryPendingJobs();
+
+    Job* job = nullptr;
+    if (! jobs.pop (job))
+    {
+        return false;
+    }
+
+    if (! jobs.isEmpty())
+    {
+        // let another worker pick up the rest of the queue
+        wakeWorkers (false);
+    }
+
+    job->state = RUNNING;
+
+    for (;;)
+    {
+        // the state store is ordered before run() reads what schedule() was called for, see schedule()
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        job->run();
+
+        int expected = RUNNING;
+        if (job->state.compare_exchange_strong (expected, IDLE))
+        {
+            break;
+        }
+
+        job->state = RUNNING;
+    }
+
+    return true;
+}
+
+CoefficientWorkerPool::Worker::Worker (CoefficientWorkerPool& p, int index)
+    : Thread { "Coefficient Worker " + juce::String (index) }, pool (p)
+{
+}
+
+void CoefficientWorkerPool::Worker::run()
+{
+    for (;;)
+    {
+        /*
+         read before looking at the queue and at the exit flag: a push after the pop failed,
+         or the destructor, moves the counter and the wait returns at once.
+         */
+        auto counter = pool.workCounter.load();
+        if (threadShouldExit())
+        {
+            return;
+        }
+
+        if (! pool.runNextJob())
+        {
+            pool.workCounter.wait (counter);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "utils/MpmcQueue.h"
+#include <JuceHeader.h>
+
+/*
+ process wide pool of threads computing filter coefficients.
+ it's meant to be accessed through juce::SharedResourcePointer, so every
+ FilterLink of every plugin instance in the process submits to the same
+ workers. the workers sleep on an atomic counter (std::atomic::wait(), a futex or
+ its equivalent) and wake up as soon as a job is scheduled, instead of polling.
+ */
+struct CoefficientWorkerPool
+{
+    enum JobState
+    {
+        IDLE,
+        QUEUED,
+        RUNNING,
+        RUNNING_AND_RESCHEDULED
+    };
+
+    struct Job
+    {
+        virtual ~Job() = default;
+        virtual void run() = 0;
+
+    private:
+        friend struct CoefficientWorkerPool;
+        std::atomic<int> state { IDLE };
+        // the next job waiting for room in the queue, see pendingJobs
+        Job* nextPending = nullptr;
+    };
+
+    CoefficientWorkerPool();
+    ~CoefficientWorkerPool();
+
+    /*
+     lock free, can be called from the audio thread: waking a worker is an atomic
+     increment and a notify_one(), which takes no lock.
+     a job is never queued twice: scheduling a queued job does nothing and
+     scheduling a running job makes it run once more when it's done.
+     a job never runs on two workers at the same time.
+     */
+    void schedule (Job& job);
+
+    /*
+     blocks until 'job' is neither queued nor running.
+     must be called before destroying a job that may have been scheduled.
+     */
+    void waitUntilIdle (Job& job);
+
+    int getNumWorkers() const;
+
+private:
+    struct Worker : juce::Thread
+    {
+        Worker (CoefficientWorkerPool& p, int index);
+        void run() override;
+
+    private:
+        CoefficientWorkerPool& pool;
+    };
+
+    bool runNextJob();
+    void wakeWorkers (bool all);
+    void addPendingJob (Job& job);
+    void retryPendingJobs();
+
+    static const size_t QUEUE_SIZE = 8192;
+
+    MpmcQueue<Job*, QUEUE_SIZE> jobs;
+    // QUEUED jobs that didn't fit in the queue, pushed again by the next schedule() or worker
+    std::atomic<Job*> pendingJobs { nullptr };
+    // bumped after every push, the workers sleep until it moves
+    std::atomic<juce::uint32> workCounter { 0 };
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientWorkerPool)
+};
@@ -7,6 +7,88 @@ namespace EqCutFilterDesign
 using namespace juce;
 using namespace juce::dsp;
 
+static const int MAX_BIQUAD_FILTERS = 4;
+
+/*
+ an order N butterworth filter is made of N / 2 second order sections,
+ plus a first order section when N is odd.
+ 'qualities' holds the Q of each second order section, scaled by 'quality'.
+ */
+struct ButterworthLayout
+{
+    bool hasFirstOrderSection = false;
+    int numBiquadFilters = 0;
+    std::array<double, MAX_BIQUAD_FILTERS> qualities {};
+};
+
+/*
+ 1 / (2 cos (angle)) of every second order section for every order, computed once:
+ only the quality scaling depends on the parameters.
+ */
+inline const std::array<std::array<double, MAX_BIQUAD_FILTERS>, 2 * MAX_BIQUAD_FILTERS + 1>& getButterworthQualityTable()
+{
+    static const auto table = []
+    {
+        std::array<std::array<double, MAX_BIQUAD_FILTERS>, 2 * MAX_BIQUAD_FILTERS + 1> qualities {};
+        for (int order = 1; order <= 2 * MAX_BIQUAD_FILTERS; ++order)
+        {
+            auto isOdd = order % 2 == 1;
+            for (int i = 0; i < order / 2; ++i)
+            {
+                auto angle = isOdd ? (i + 1.0) * MathConstants<double>::pi / order //
+                                   : (2.0 * i + 1.0) * MathConstants<double>::pi / (order * 2.0);
+                qualities[static_cast<size_t> (order)][static_cast<size_t> (i)] = 1.0 / (2.0 * std::cos (angle));
+            }
+        }
+        return qualities;
+    }();
+
+    return table;
+}
+
+/*
+ x^(1/n) for the number of second order sections a cut filter can have, without std::pow.
+ */
+inline double getNthRoot (double x, int n)
+{
+    switch (n)
+    {
+        case 1:
+            return x;
+        case 2:
+            return std::sqrt (x);
+        case 3:
+            return std::cbrt (x);
+        case 4:
+            return std::sqrt (std::sqrt (x));
+        default:
+            jassertfalse;
+            return std::pow (x, 1.0 / n);
+    }
+}
+
+inline ButterworthLayout getButterworthLayout (int order, float quality)
+{
+    jassert (order > 0 && order <= 2 * MAX_BIQUAD_FILTERS);
+
+    ButterworthLayout layout;
+    layout.hasFirstOrderSection = order % 2 == 1;
+    layout.numBiquadFilters = juce::jmin (order / 2, MAX_BIQUAD_FILTERS);
+    if (layout.numBiquadFilters == 0)
+    {
+        return layout;
+    }
+
+    auto a = getNthRoot (quality * MathConstants<double>::sqrt2, layout.numBiquadFilters);
+    const auto& qualityTable = getButterworthQualityTable()[static_cast<size_t> (order)];
+    for (size_t i = 0; i < static_cast<size_t> (layout.numBiquadFilters); ++i)
+    {
+        layout.qualities[i] = a * qualityTable[i];
+    }
+
+    return layout;
+}
+
 template <typename FloatType>
 juce::ReferenceCountedArray<IIR::Coefficients<FloatType>> designIIRHighpassHighOrderButterworthMethod (FloatType frequency, //
                                                                                                        double sampleRate,
@@ -19,25 +101,16 @@ juce::ReferenceCountedArray<IIR::Coefficients<FloatType>> designIIRHighpassHighO
 
     ReferenceCountedArray<IIR::Coefficients<FloatType>> arrayFilters;
 
-    auto numBiquadFilters = order / 2;
-    auto a = std::pow (quality * MathConstants<float>::sqrt2, 1.0f / static_cast<float> (numBiquadFilters));
-    if (order % 2 == 1)
+    auto layout = getButterworthLayout (order, quality);
+    if (layout.hasFirstOrderSection)
     {
         arrayFilters.add (*IIR::Coefficients<FloatType>::makeFirstOrderHighPass (sampleRate, frequency));
-
-        for (int i = 0; i < numBiquadFilters; ++i)
-        {
-            auto Q = a / (2.0 * std::cos ((i + 1.0) * MathConstants<double>::pi / order));
-            arrayFilters.add (*IIR::Coefficients<FloatType>::makeHighPass (sampleRate, frequency, static_cast<FloatType> (Q)));
-        }
     }
-    else
+
+    for (int i = 0; i < layout.numBiquadFilters; ++i)
     {
-        for (int i = 0; i < numBiquadFilters; ++i)
-        {
-            auto Q = a / (2.0 * std::cos ((2.0 * i + 1.0) * MathConstants<double>::pi / (order * 2.0)));
-            arrayFilters.add (*IIR::Coefficients<FloatType>::makeHighPass (sampleRate, frequency, static_cast<FloatType> (Q)));
-        }
+        auto Q = layout.qualities[static_cast<size_t> (i)];
+        arrayFilters.add (*IIR::Coefficients<FloatType>::makeHighPass (sampleRate, frequency, static_cast<FloatType> (Q)));
     }
 
     return arrayFilters;
@@ -55,25 +128,16 @@ ReferenceCountedArray<IIR::Coefficients<FloatType>> designIIRLowpassHighOrderBut
 
     ReferenceCountedArray<IIR::Coefficients<FloatType>> arrayFilters;
 
-    auto numBiquadFilters = order / 2;
-    auto a = std::pow (quality * MathConstants<float>::sqrt2, 1.0f / static_cast<float> (numBiquadFilters));
-    if (order % 2 == 1)
+    auto layout = getButterworthLayout (order, quality);
+    if (layout.hasFirstOrderSection)
     {
         arrayFilters.add (*IIR::Coefficients<FloatType>::makeFirstOrderLowPass (sampleRate, frequency));
-
-        for (int i = 0; i < numBiquadFilters; ++i)
-        {
-            auto Q = a / (2.0 * std::cos ((i + 1.0) * MathConstants<double>::pi / order));
-            arrayFilters.add (*IIR::Coefficients<FloatType>::makeLowPass (sampleRate, frequency, static_cast<FloatType> (Q)));
-        }
     }
-    else
+
+    for (int i = 0; i < layout.numBiquadFilters; ++i)
     {
-        for (int i = 0; i < numBiquadFilters; ++i)
-        {
-            auto Q = a / (2.0 * std::cos ((2.0 * i + 1.0) * MathConstants<double>::pi / (order * 2.0)));
-            arrayFilters.add (*IIR::Coefficients<FloatType>::makeLowPass (sampleRate, frequency, static_cast<FloatType> (Q)));
-        }
+        auto Q = layout.qualities[static_cast<size_t> (i)];
+        arrayFilters.add (*IIR::Coefficients<FloatType>::makeLowPass (sampleRate, frequency, static_cast<FloatType> (Q)));
     }
 
     return arrayFilters;
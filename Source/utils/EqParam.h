@@ -14,3 +14,11 @@ enum class EqMode
     MID_SIDE
 };
 //==============================================================================
+enum class FilterEngine
+{
+    BIQUAD,
+    SVF,
+    PARALLEL,
+    LINEAR_PHASE
+};
+//==============================================================================
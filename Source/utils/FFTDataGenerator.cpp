@@ -50,3 +50,8 @@ bool FFTDataGenerator::getFFTData (std::vector<float>&& fftDataReceiver)
 {
     return fftDataFifo.exchange (std::move (fftDataReceiver));
 }
+
+size_t FFTDataGenerator::getMemoryFootprint() const
+{
+    return sizeof (*this) - sizeof (fftDataFifo) + fftDataFifo.getMemoryFootprint() + MemoryFootprint::getHeapBytes (fftData);
+}
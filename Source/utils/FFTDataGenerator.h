@@ -25,11 +25,17 @@ struct FFTDataGenerator
 
     bool getFFTData (std::vector<float>&& fftDataReceiver);
 
+    size_t getMemoryFootprint() const;
+
 private:
     FFTOrder order { FFTOrder::order2048 };
     std::vector<float> fftData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
     std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
 
-    Fifo<std::vector<float>, 100> fftDataFifo;
+    /*
+     the PathProducer drains the fifo right after producing each block, on the same thread:
+     it never holds more than one, and a Fifo of size N holds N - 1.
+     */
+    Fifo<std::vector<float>, 2> fftDataFifo;
 };
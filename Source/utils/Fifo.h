@@ -1,5 +1,6 @@
 #pragma once
 
+#include "utils/MemoryFootprint.h"
 #include <JuceHeader.h>
 #include <cstddef>
 
@@ -46,6 +47,14 @@ struct IsAudioBuffer<juce::AudioBuffer<T>> : std::true_type
 template <typename T, size_t Size>
 struct Fifo
 {
+    /*
+     no reference counted pointers: the audio thread, reading, could drop the last reference
+     of an object and free it. what allocates travels in slots that are swapped back and
+     forth (see exchange()), and coefficients travel by value (see SectionRecord).
+     */
+    static_assert (! IsReferenceCountedObjectPtr<T>::value && ! IsReferenceCountedArray<T>::value,
+                   "Fifo can't hold reference counted pointers");
+
     size_t getSize() const noexcept
     {
         return Size;
@@ -80,17 +89,7 @@ struct Fifo
         auto write = fifo.write (1);
         if (write.blockSize1 > 0)
         {
-            size_t index = static_cast<size_t> (write.startIndex1);
-            if constexpr (IsReferenceCountedObjectPtr<T>::value)
-            {
-                T old = buffer[index];
-                buffer[index] = t;
-                jassert (old.get() == nullptr || old->getReferenceCount() > 1);
-            }
-            else
-            {
-                buffer[index] = t;
-            }
+            buffer[static_cast<size_t> (write.startIndex1)] = t;
             return true;
         }
         return false;
@@ -107,24 +106,16 @@ struct Fifo
         return false;
     }
 
+    // swaps the next item with 't', so that the slot keeps a buffer of at least its size
     bool exchange (T&& t)
     {
+        static_assert (IsVector<T>::value || IsAudioBuffer<T>::value, "exchange() only supports std::vector and juce::AudioBuffer");
         auto read = fifo.read (1);
 
         if (read.blockSize1 > 0)
         {
             size_t index = static_cast<size_t> (read.startIndex1);
-            if constexpr (IsReferenceCountedObjectPtr<T>::value)
-            {
-                std::swap (buffer[index], t);
-                jassert (buffer[index].get() == nullptr);
-            }
-            else if constexpr (IsReferenceCountedArray<T>::value)
-            {
-                std::swap (buffer[index], t);
-                jassert (buffer[index].isEmpty());
-            }
-            else if constexpr (IsVector<T>::value)
+            if constexpr (IsVector<T>::value)
             {
                 if (t.size() < buffer[index].size())
                 {
@@ -135,7 +126,7 @@ struct Fifo
                     std::swap (buffer[index], t);
                 }
             }
-            else if constexpr (IsAudioBuffer<T>::value)
+            else
             {
                 if (t.getNumSamples() < buffer[index].getNumSamples())
                 {
@@ -146,11 +137,6 @@ struct Fifo
                     std::swap (buffer[index], t);
                 }
             }
-            else
-            {
-                std::swap (buffer[index], t);
-                jassert (buffer[index] == nullptr);
-            }
             return true;
         }
 
@@ -167,6 +153,17 @@ struct Fifo
         return fifo.getFreeSpace();
     }
 
+    // the slots and the buffers they own, see MemoryFootprint
+    size_t getMemoryFootprint() const
+    {
+        auto bytes = sizeof (*this);
+        for (const auto& item : buffer)
+        {
+            bytes += MemoryFootprint::getHeapBytes (item);
+        }
+        return bytes;
+    }
+
 private:
     juce::AbstractFifo fifo { Size };
     std::array<T, Size> buffer;
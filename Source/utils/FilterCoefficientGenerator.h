@@ -1,81 +1,60 @@
 #pragma once
 
-#include "utils/Fifo.h"
+#include "utils/CoefficientWorkerPool.h"
+#include "utils/Mailbox.h"
 #include <JuceHeader.h>
 
-template <typename CoefficientType>
-struct IsCoefficientsArray : std::false_type
+/*
+ turns parameter changes into coefficients on the shared CoefficientWorkerPool.
+ the generator itself owns no thread: changeParameters() schedules it on the
+ pool, which runs it as soon as a worker is free.
+ parameters and coefficients go through Mailboxes: a burst of changes is coalesced
+ into the coefficients of the latest parameters, older ones are never computed.
+ */
+template <typename CoefficientType, typename ParamType, typename MakeFunction>
+struct FilterCoefficientGenerator : CoefficientWorkerPool::Job
 {
-};
-
-template <typename CoefficientType>
-struct IsCoefficientsArray<juce::ReferenceCountedArray<CoefficientType>> : std::true_type
-{
-};
-
-template <typename CoefficientType, typename ParamType, typename MakeFunction, size_t Size>
-struct FilterCoefficientGenerator : juce::Thread
-{
-    FilterCoefficientGenerator (Fifo<CoefficientType, Size>& coefficientsBuffer)
-        : Thread { "Filter Coefficient Generator" }, coefficientsFifo (coefficientsBuffer)
+    FilterCoefficientGenerator (Mailbox<CoefficientType>& coefficientsToUse) : coefficientsMailbox (coefficientsToUse)
     {
-        startThread();
     }
 
     ~FilterCoefficientGenerator() override
     {
-        stopThread (1000);
+        workerPool->waitUntilIdle (*this);
     }
 
     void changeParameters (ParamType params)
     {
-        auto parameterStored = parametersFifo.push (params);
-        jassert (parameterStored);
-        hasParametersChanged = true;
+        parametersMailbox.write (params);
+        workerPool->schedule (*this);
     }
 
+    // a change written while this runs schedules it once more, see CoefficientWorkerPool::schedule()
     void run() override
     {
-        while (! threadShouldExit())
+        ParamType params;
+        if (! parametersMailbox.read (params))
         {
-            if (hasParametersChanged.compareAndSetBool (false, true))
-            {
-                while (parametersFifo.getNumAvailableForReading() > 0)
-                {
-                    ParamType poppedParams;
-                    auto gotParameters = parametersFifo.pull (poppedParams);
-                    jassert (gotParameters);
-
-                    auto coefficients = MakeFunction::make (poppedParams);
-                    if (receivedNewCoefficients (coefficients))
-                    {
-                        auto pushSuccess = coefficientsFifo.push (coefficients);
-                        jassert (pushSuccess);
-                    }
-                }
-            }
+            return;
+        }
 
-            wait (SLEEP_TIME_MS);
+        auto coefficients = MakeFunction::make (params);
+        if (receivedNewCoefficients (coefficients))
+        {
+            coefficientsMailbox.write (coefficients);
         }
     }
 
 private:
-    bool receivedNewCoefficients (CoefficientType& coefficients)
+    // see SectionRecord, a record without sections comes from invalid parameters
+    static bool receivedNewCoefficients (const CoefficientType& coefficients)
     {
-        if constexpr (IsCoefficientsArray<CoefficientType>::value)
-        {
-            return coefficients.size() > 0;
-        }
-        else
-        {
-            return coefficients != nullptr;
-        }
+        return coefficients.numSections > 0;
     }
 
-    static const int SLEEP_TIME_MS = 10;
-    Fifo<CoefficientType, Size>& coefficientsFifo;
-    Fifo<ParamType, Size> parametersFifo;
-    juce::Atomic<bool> hasParametersChanged { false };
+    Mailbox<CoefficientType>& coefficientsMailbox;
+    Mailbox<ParamType> parametersMailbox;
+    juce::SharedResourcePointer<CoefficientWorkerPool> workerPool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterCoefficientGenerator)
 };
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "data/MeterValues.h"
+#include <JuceHeader.h>
+
+/*
+ the per block signal path in a single pass: every chunk of CHUNK_SIZE samples is
+ trimmed by the input gain, metered, filtered, trimmed by the output gain and metered
+ again while it is in L1, instead of a full pass over the buffer per stage.
+ the stages that can be skipped (a gain trim at 0 dB, the analyzer taps) are template
+ flags: dispatch() picks the specialisation for the stages that are enabled, the
+ chunk loop itself has no branches for them.
+ */
+namespace FusedBlockPipeline
+{
+enum Stage : unsigned
+{
+    INPUT_GAIN = 1 << 0,
+    PRE_FILTER_TAP = 1 << 1,
+    POST_FILTER_TAP = 1 << 2,
+    OUTPUT_GAIN = 1 << 3,
+    LAST_STAGE = OUTPUT_GAIN
+};
+
+// 2 channels of 256 doubles stay well within L1, whatever the host block size
+static const size_t CHUNK_SIZE = 256;
+
+/*
+ peak and sum of squares of the first two channels, accumulated chunk by chunk.
+ a mono block is metered on both sides.
+ add() reads both channels in a single pass. it keeps NUM_ACCUMULATORS independent
+ maxima and sums per channel, reduced once per chunk, so the loop carries no dependency
+ from one sample to the next.
+ addScaled() applies a gain to the chunk in the same pass, the output trim and the
+ output meter need a single one.
+ */
+template <typename SampleType>
+struct Meter
+{
+    // a cache line of samples per step
+    static constexpr size_t NUM_ACCUMULATORS = 64 / sizeof (SampleType);
+
+    void reset()
+    {
+        peaks = {};
+        sumsOfSquares = {};
+        numSamples = 0;
+    }
+
+    void add (const juce::dsp::AudioBlock<SampleType>& chunk) noexcept
+    {
+        accumulate<false> (chunk, SampleType (1));
+    }
+
+    // the metered values are the scaled ones
+    void addScaled (const juce::dsp::AudioBlock<SampleType>& chunk, SampleType gain) noexcept
+    {
+        for (size_t channel = 2; channel < chunk.getNumChannels(); ++channel)
+        {
+            juce::FloatVectorOperations::multiply (chunk.getChannelPointer (channel), gain, static_cast<int> (chunk.getNumSamples()));
+        }
+
+        accumulate<true> (chunk, gain);
+    }
+
+    MeterValues getMeterValues() const
+    {
+        auto rms = [this] (size_t side)
+        { return numSamples > 0 ? static_cast<float> (std::sqrt (sumsOfSquares[side] / static_cast<SampleType> (numSamples))) : 0.0f; };
+
+        MeterValues meterValues;
+        meterValues.leftPeakDb.setGain (static_cast<float> (peaks[0]));
+        meterValues.rightPeakDb.setGain (static_cast<float> (peaks[1]));
+        meterValues.leftRmsDb.setGain (rms (0));
+        meterValues.rightRmsDb.setGain (rms (1));
+        return meterValues;
+    }
+
+private:
+    using Accumulators = std::array<SampleType, NUM_ACCUMULATORS>;
+
+    // a mono chunk reads and writes the same channel twice: both reads happen before the writes
+    template <bool Scale>
+    void accumulate (const juce::dsp::AudioBlock<SampleType>& chunk, SampleType gain) noexcept
+    {
+        if (chunk.getNumChannels() == 0)
+        {
+            return;
+        }
+
+        auto* left = chunk.getChannelPointer (0);
+        auto* right = chunk.getChannelPointer (juce::jmin (static_cast<size_t> (1), chunk.getNumChannels() - 1));
+        const auto numChunkSamples = chunk.getNumSamples();
+
+        Accumulators leftPeaks {}, rightPeaks {}, leftSums {}, rightSums {};
+        size_t i = 0;
+        for (; i + NUM_ACCUMULATORS <= numChunkSamples; i += NUM_ACCUMULATORS)
+        {
+            for (size_t j = 0; j < NUM_ACCUMULATORS; ++j)
+            {
+                auto l = left[i + j];
+                auto r = right[i + j];
+                if constexpr (Scale)
+                {
+                    l *= gain;
+                    r *= gain;
+                    left[i + j] = l;
+                    right[i + j] = r;
+                }
+                leftPeaks[j] = juce::jmax (leftPeaks[j], std::abs (l));
+                rightPeaks[j] = juce::jmax (rightPeaks[j], std::abs (r));
+                leftSums[j] += l * l;
+                rightSums[j] += r * r;
+            }
+        }
+
+        auto leftPeak = peaks[0];
+        auto rightPeak = peaks[1];
+        SampleType leftSum {}, rightSum {};
+        for (; i < numChunkSamples; ++i)
+        {
+            auto l = left[i];
+            auto r = right[i];
+            if constexpr (Scale)
+            {
+                l *= gain;
+                r *= gain;
+                left[i] = l;
+                right[i] = r;
+            }
+            leftPeak = juce::jmax (leftPeak, std::abs (l));
+            rightPeak = juce::jmax (rightPeak, std::abs (r));
+            leftSum += l * l;
+            rightSum += r * r;
+        }
+
+        for (size_t j = 0; j < NUM_ACCUMULATORS; ++j)
+        {
+            leftPeak = juce::jmax (leftPeak, leftPeaks[j]);
+            rightPeak = juce::jmax (rightPeak, rightPeaks[j]);
+            leftSum += leftSums[j];
+            rightSum += rightSums[j];
+        }
+
+        peaks = { leftPeak, rightPeak };
+        sumsOfSquares[0] += leftSum;
+        sumsOfSquares[1] += rightSum;
+        numSamples += numChunkSamples;
+    }
+
+    std::array<SampleType, 2> peaks {};
+    std::array<SampleType, 2> sumsOfSquares {};
+    size_t numSamples = 0;
+};
+
+template <typename SampleType>
+struct Stages
+{
+    juce::dsp::Gain<SampleType>& inputGain;
+    juce::dsp::Gain<SampleType>& outputGain;
+    Meter<SampleType>& inputMeter;
+    Meter<SampleType>& outputMeter;
+};
+
+template <unsigned EnabledStages, typename SampleType, typename Filter, typename PreFilterTap, typename PostFilterTap>
+void process (juce::dsp::AudioBlock<SampleType>& block,
+              Stages<SampleType>& stages,
+              Filter&& filter,
+              PreFilterTap&& preFilterTap,
+              PostFilterTap&& postFilterTap)
+{
+    stages.inputMeter.reset();
+    stages.outputMeter.reset();
+
+    for (size_t offset = 0; offset < block.getNumSamples(); offset += CHUNK_SIZE)
+    {
+        auto chunk = block.getSubBlock (offset, juce::jmin (CHUNK_SIZE, block.getNumSamples() - offset));
+
+        if constexpr ((EnabledStages & INPUT_GAIN) != 0)
+        {
+            stages.inputGain.process (juce::dsp::ProcessContextReplacing<SampleType> (chunk));
+        }
+
+        stages.inputMeter.add (chunk);
+
+        if constexpr ((EnabledStages & PRE_FILTER_TAP) != 0)
+        {
+            preFilterTap (chunk);
+        }
+
+        filter (chunk);
+
+        if constexpr ((EnabledStages & POST_FILTER_TAP) != 0)
+        {
+            postFilterTap (chunk);
+        }
+
+        if constexpr ((EnabledStages & OUTPUT_GAIN) != 0)
+        {
+            if (stages.outputGain.isSmoothing())
+            {
+                stages.outputGain.process (juce::dsp::ProcessContextReplacing<SampleType> (chunk));
+                stages.outputMeter.add (chunk);
+            }
+            else
+            {
+                stages.outputMeter.addScaled (chunk, stages.outputGain.getGainLinear());
+            }
+        }
+        else
+        {
+            stages.outputMeter.add (chunk);
+        }
+    }
+}
+
+// calls the process() specialisation for 'enabledStages', one stage flag at a time
+template <typename SampleType, unsigned EnabledStages = 0, unsigned NextStage = 1, typename... Args>
+void dispatch (unsigned enabledStages, juce::dsp::AudioBlock<SampleType>& block, Stages<SampleType>& stages, Args&&... args)
+{
+    if constexpr (NextStage > LAST_STAGE)
+    {
+        process<EnabledStages> (block, stages, std::forward<Args> (args)...);
+    }
+    else if ((enabledStages & NextStage) != 0)
+    {
+        dispatch<SampleType, EnabledStages | NextStage, (NextStage << 1)> (enabledStages, block, stages, std::forward<Args> (args)...);
+    }
+    else
+    {
+        dispatch<SampleType, EnabledStages, (NextStage << 1)> (enabledStages, block, stages, std::forward<Args> (args)...);
+    }
+}
+
+// a trim at 0 dB, and not ramping towards another gain, can be skipped
+template <typename SampleType>
+bool isGainStageNeeded (const juce::dsp::Gain<SampleType>& gain)
+{
+    return gain.isSmoothing() || gain.getGainLinear() != SampleType (1);
+}
+} // namespace FusedBlockPipeline
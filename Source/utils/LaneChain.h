@@ -0,0 +1,352 @@
+#pragma once
+
+#include "utils/BatchCoefficientsMaker.h"
+#include "utils/BiquadLaneCascade.h"
+#include "utils/ChainHelpers.h"
+#include "utils/ParallelBiquadLanes.h"
+#include "utils/ParallelFormConverter.h"
+#include <JuceHeader.h>
+
+/*
+ processes NumLanes MonoChains in lockstep through a single BiquadLaneCascade.
+ the MonoChains keep doing what they always did (parameters, smoothing and
+ coefficient generation) and the LaneChain mirrors their sections into the
+ cascade whenever a link loads new coefficients or becomes (in)active.
+ while links are smoothing, the LaneChain computes the sections of all of them
+ in one CoefficientsBatch instead, once per update.
+ with a ramp length, sections that stay in use ramp towards their new
+ coefficients over that many samples instead of jumping to them.
+ slots that no lane uses are left out of the cascade altogether.
+
+ the links compute float coefficients: a double precision LaneChain
+ computes all of its sections itself, from the links' parameters, so that
+ nothing on its path is rounded to float.
+
+ with the parallel form enabled, the sections of every lane are converted into
+ a sum of parallel sections whenever they change, and processed by a
+ ParallelBiquadLanes instead of the cascade. a lane whose conversion is ill-conditioned
+ makes the whole chain fall back to the cascade until the sections change again.
+ the state moves over on every switch between the two, and coefficients jump
+ instead of ramping while the parallel form is in use.
+ */
+template <size_t NumLanes, typename FloatType = float>
+struct LaneChain
+{
+    using Chains = std::array<ChainHelpers::MonoChain*, NumLanes>;
+
+    // 4 sections for each cut filter, 1 for each parametric band
+    static const size_t NUM_SLOTS = 14;
+
+    void reset()
+    {
+        cascade.reset();
+        parallel.reset();
+        usingParallelForm = false;
+        needsRefresh = true;
+    }
+
+    void setParallelFormEnabled (bool shouldBeEnabled)
+    {
+        if (parallelFormEnabled != shouldBeEnabled)
+        {
+            parallelFormEnabled = shouldBeEnabled;
+            parallelFormChanged = true;
+        }
+    }
+
+    bool isUsingParallelForm() const
+    {
+        return usingParallelForm;
+    }
+
+    void update (const Chains& chains, size_t rampLength = 0)
+    {
+        // the versions a lane has seen belong to the chain it was mirroring
+        if (chains != currentChains)
+        {
+            currentChains = chains;
+            needsRefresh = true;
+        }
+
+        bool slotsChanged = needsRefresh;
+        batch.clear();
+        currentRampLength = needsRefresh || usingParallelForm ? 0 : rampLength;
+
+        slotsChanged |= updateBand<ChainPositions::LOWCUT> (chains);
+        slotsChanged |= updateBand<ChainPositions::LOWSHELF> (chains);
+        slotsChanged |= updateBand<ChainPositions::PEAK1> (chains);
+        slotsChanged |= updateBand<ChainPositions::PEAK2> (chains);
+        slotsChanged |= updateBand<ChainPositions::PEAK3> (chains);
+        slotsChanged |= updateBand<ChainPositions::PEAK4> (chains);
+        slotsChanged |= updateBand<ChainPositions::HIGHSHELF> (chains);
+        slotsChanged |= updateBand<ChainPositions::HIGHCUT> (chains);
+
+        if (batch.size() > 0)
+        {
+            batch.compute();
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                const auto& destination = batchDestinations[i];
+                setSection (destination.slot, destination.lane, batch.getSection (i), destination.wasInUse);
+            }
+        }
+
+        if (slotsChanged)
+        {
+            rebuildActiveSlots();
+        }
+
+        if (slotsChanged || parallelFormChanged)
+        {
+            updateParallelForm();
+        }
+
+        needsRefresh = false;
+        parallelFormChanged = false;
+    }
+
+    void process (const juce::dsp::AudioBlock<FloatType>& block) noexcept
+    {
+        jassert (block.getNumChannels() >= NumLanes);
+
+        std::array<FloatType*, NumLanes> channels;
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            channels[lane] = block.getChannelPointer (lane);
+        }
+
+        process (channels.data(), block.getNumSamples());
+    }
+
+    void process (FloatType* const* channels, size_t numSamples) noexcept
+    {
+        if (usingParallelForm)
+        {
+            parallel.process (channels, numSamples);
+        }
+        else
+        {
+            cascade.process (channels, numSamples);
+        }
+    }
+
+private:
+    struct BandState
+    {
+        int version = -1;
+        int smoothedVersion = 0;
+        bool active = false;
+    };
+
+    struct BatchDestination
+    {
+        size_t slot = 0;
+        size_t lane = 0;
+        bool wasInUse = false;
+    };
+
+    static constexpr size_t getFirstSlot (ChainPositions position)
+    {
+        auto index = static_cast<size_t> (position);
+        return index == 0 ? 0 : index + 3;
+    }
+
+    template <ChainPositions FilterPosition>
+    bool updateBand (const Chains& chains)
+    {
+        const int filterIndex = static_cast<int> (FilterPosition);
+        const size_t firstSlot = getFirstSlot (FilterPosition);
+        bool changed = false;
+
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            const auto& link = chains[lane]->template get<filterIndex>();
+            using LinkType = std::remove_cv_t<std::remove_reference_t<decltype (link)>>;
+
+            auto& bandState = bandStates[static_cast<size_t> (filterIndex)][lane];
+            auto version = link.getCoefficientsVersion();
+            auto smoothedVersion = link.getSmoothedParametersVersion();
+            auto active = link.isActive();
+
+            auto hasNewSmoothedParameters = bandState.smoothedVersion != smoothedVersion;
+            if (! needsRefresh && ! hasNewSmoothedParameters && bandState.version == version && bandState.active == active)
+            {
+                continue;
+            }
+
+            bandState.version = version;
+            bandState.smoothedVersion = smoothedVersion;
+            bandState.active = active;
+
+            if (active && (hasNewSmoothedParameters || ! USES_LINK_COEFFICIENTS))
+            {
+                auto firstBatchIndex = batch.size();
+                auto numSections = batch.addSections (hasNewSmoothedParameters ? link.getSmoothedParameters()
+                                                                               : link.getRequestedParameters());
+
+                for (size_t section = 0; section < LinkType::MAX_SECTIONS; ++section)
+                {
+                    auto slot = firstSlot + section;
+                    auto inUse = section < numSections;
+                    if (inUse)
+                    {
+                        batchDestinations[firstBatchIndex + section] = { slot, lane, slotInUse[slot][lane] };
+                    }
+                    else
+                    {
+                        cascade.setCoefficients (slot, lane, BiquadSection<FloatType>::identity());
+                    }
+                    slotInUse[slot][lane] = inUse;
+                }
+            }
+            else
+            {
+                typename LinkType::Sections sections;
+                auto numSections = link.getSections (sections);
+
+                for (size_t section = 0; section < LinkType::MAX_SECTIONS; ++section)
+                {
+                    auto slot = firstSlot + section;
+                    auto inUse = section < numSections;
+                    if (inUse)
+                    {
+                        setSection (slot, lane, BiquadSection<FloatType>::fromSection (sections[section]), slotInUse[slot][lane]);
+                    }
+                    else
+                    {
+                        cascade.setCoefficients (slot, lane, BiquadSection<FloatType>::identity());
+                    }
+                    slotInUse[slot][lane] = inUse;
+                }
+            }
+
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    // a section that just came into use has no meaningful coefficients to ramp from
+    void setSection (size_t slot, size_t lane, const BiquadSection<FloatType>& section, bool wasInUse)
+    {
+        if (wasInUse)
+        {
+            cascade.setTargetCoefficients (slot, lane, section, currentRampLength);
+        }
+        else
+        {
+            cascade.setCoefficients (slot, lane, section);
+        }
+    }
+
+    void rebuildActiveSlots()
+    {
+        std::array<size_t, NUM_SLOTS> activeSlots {};
+        size_t numActiveSlots = 0;
+
+        for (size_t slot = 0; slot < NUM_SLOTS; ++slot)
+        {
+            auto& lanes = slotInUse[slot];
+            if (std::any_of (lanes.begin(), lanes.end(), [] (bool inUse) { return inUse; }))
+            {
+                activeSlots[numActiveSlots++] = slot;
+            }
+        }
+
+        cascade.setActiveSlots (activeSlots, numActiveSlots);
+    }
+
+    /*
+     converts every lane, slot by slot: parallel section j has the poles of slot j,
+     and unused slots are identity sections without poles.
+     the state moves to the parallel form with the new sections, and back to the
+     cascade with the ones the parallel form was running with.
+     */
+    void updateParallelForm()
+    {
+        auto canUseParallelForm = parallelFormEnabled;
+        for (size_t lane = 0; lane < NumLanes && canUseParallelForm; ++lane)
+        {
+            typename Converter::Sections sections;
+            for (size_t slot = 0; slot < NUM_SLOTS; ++slot)
+            {
+                sections[slot] = BiquadSection<double>::fromSection (cascade.getTargetCoefficients (slot, lane));
+            }
+
+            canUseParallelForm = pendingConverters[lane].convert (sections, std::numeric_limits<FloatType>::epsilon());
+        }
+
+        if (canUseParallelForm)
+        {
+            for (size_t lane = 0; lane < NumLanes; ++lane)
+            {
+                const auto& converter = pendingConverters[lane];
+                if (! usingParallelForm)
+                {
+                    setState (parallel, lane, converter.getParallelState (getState (cascade, lane)));
+                }
+
+                std::array<BiquadSection<FloatType>, NUM_SLOTS> parallelSections;
+                for (size_t slot = 0; slot < NUM_SLOTS; ++slot)
+                {
+                    parallelSections[slot] = BiquadSection<FloatType>::fromSection (converter.getParallelSections()[slot]);
+                }
+                parallel.setSections (lane, static_cast<FloatType> (converter.getDirectGain()), parallelSections);
+            }
+
+            std::swap (converters, pendingConverters);
+        }
+        else if (usingParallelForm)
+        {
+            for (size_t lane = 0; lane < NumLanes; ++lane)
+            {
+                setState (cascade, lane, converters[lane].getCascadeState (getState (parallel, lane)));
+            }
+        }
+
+        usingParallelForm = canUseParallelForm;
+    }
+
+    using Converter = ParallelFormConverter<NUM_SLOTS>;
+
+    template <typename Processor>
+    static typename Converter::States getState (const Processor& processor, size_t lane)
+    {
+        typename Converter::States states;
+        for (size_t slot = 0; slot < NUM_SLOTS; ++slot)
+        {
+            FloatType s1, s2;
+            processor.getState (slot, lane, s1, s2);
+            states[slot] = { static_cast<double> (s1), static_cast<double> (s2) };
+        }
+        return states;
+    }
+
+    template <typename Processor>
+    static void setState (Processor& processor, size_t lane, const typename Converter::States& states)
+    {
+        for (size_t slot = 0; slot < NUM_SLOTS; ++slot)
+        {
+            processor.setState (slot, lane, static_cast<FloatType> (states[slot].s1), static_cast<FloatType> (states[slot].s2));
+        }
+    }
+
+    static constexpr bool USES_LINK_COEFFICIENTS = std::is_same_v<FloatType, float>;
+
+    BiquadLaneCascade<FloatType, NumLanes, NUM_SLOTS> cascade;
+    ParallelBiquadLanes<FloatType, NumLanes, NUM_SLOTS> parallel;
+    std::array<Converter, NumLanes> converters;
+    std::array<Converter, NumLanes> pendingConverters;
+    CoefficientsBatch<NUM_SLOTS * NumLanes, FloatType> batch;
+    std::array<BatchDestination, NUM_SLOTS * NumLanes> batchDestinations;
+    std::array<std::array<BandState, NumLanes>, 8> bandStates;
+    std::array<std::array<bool, NumLanes>, NUM_SLOTS> slotInUse {};
+    Chains currentChains {};
+    bool needsRefresh = true;
+    size_t currentRampLength = 0;
+    bool parallelFormEnabled = false;
+    bool parallelFormChanged = false;
+    bool usingParallelForm = false;
+};
+
+using StereoChain = LaneChain<2>;
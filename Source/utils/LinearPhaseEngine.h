@@ -0,0 +1,305 @@
+#pragma once
+
+#include "utils/ChainHelpers.h"
+#include "utils/ChannelGroups.h"
+#include "utils/CoefficientWorkerPool.h"
+#include "utils/SpscRing.h"
+#include "utils/LinearPhaseFirDesign.h"
+#include <JuceHeader.h>
+
+/*
+ the linear phase processing mode: each channel goes through a symmetric FIR with the
+ magnitude response of the MonoChain of its group (the response the ResponseCurveComponent draws).
+ - update() compares the target parameters of the chains and the channel groups with the
+   ones of the current FIRs, the processor calls it when they may have changed. when they
+   differ, new FIRs are designed on the CoefficientWorkerPool, never on the audio thread.
+ - juce::dsp::Convolution runs the FIRs with non uniform partitioning: a short head
+   partition keeps the convolution itself free of latency, the longer tail partitions
+   keep the cost per sample low. it crossfades from the old FIRs to the new ones.
+   a Convolution handles at most two channels: there is one per pair of channels,
+   they share a single background loading thread.
+ - the latency is the one of the FIRs, half their length.
+ juce::dsp::Convolution only processes float: double blocks go through a float buffer.
+ */
+struct LinearPhaseEngine : CoefficientWorkerPool::Job
+{
+    // the parameters of each group, indexed by Channel
+    using Parameters = std::array<LinearPhaseFirDesign::ChainParameters, 2>;
+
+    // the size of the first, uniformly partitioned, part of the FIR
+    static const int HEAD_SIZE = 256;
+
+    static const size_t MAX_PAIRS = (ChannelGroups::MAX_CHANNELS + 1) / 2;
+
+    LinearPhaseEngine()
+    {
+        for (size_t pair = 0; pair < MAX_PAIRS; ++pair)
+        {
+            convolutions.add (new juce::dsp::Convolution (juce::dsp::Convolution::NonUniform { HEAD_SIZE }, messageQueue));
+        }
+    }
+
+    ~LinearPhaseEngine() override
+    {
+        workerPool->waitUntilIdle (*this);
+    }
+
+    // not on the audio thread, it waits for a running design to finish
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        jassert (spec.numChannels > 0 && spec.numChannels <= ChannelGroups::MAX_CHANNELS);
+        workerPool->waitUntilIdle (*this);
+
+        sampleRate = spec.sampleRate;
+        numChannels = juce::jlimit (static_cast<size_t> (1), ChannelGroups::MAX_CHANNELS, static_cast<size_t> (spec.numChannels));
+        designer = std::make_unique<LinearPhaseFirDesign::FirDesigner> (LinearPhaseFirDesign::getFftOrder (sampleRate));
+        floatBuffer.setSize (static_cast<int> (numChannels), static_cast<int> (spec.maximumBlockSize));
+
+        auto pairSpec = spec;
+        pairSpec.numChannels = 2;
+        for (size_t pair = 0; pair < getNumPairs(); ++pair)
+        {
+            convolutions[static_cast<int> (pair)]->prepare (pairSpec);
+        }
+
+        Design unusedDesign;
+        while (designFifo.pull (unusedDesign))
+        {
+        }
+        hasDesign = false;
+    }
+
+    void reset()
+    {
+        for (auto* convolution : convolutions)
+        {
+            convolution->reset();
+        }
+    }
+
+    int getFirLengthInSamples() const
+    {
+        jassert (designer != nullptr);
+        return designer->getFftSize();
+    }
+
+    // the partitions of the Convolutions, allocated by juce, are not counted, see MemoryFootprint
+    size_t getMemoryFootprint() const
+    {
+        auto bytes = sizeof (*this) + MemoryFootprint::getHeapBytes (floatBuffer) + designFifo.getMemoryFootprint() - sizeof (designFifo);
+        if (designer != nullptr)
+        {
+            bytes += designer->getMemoryFootprint();
+        }
+        return bytes;
+    }
+
+    int getLatencyInSamples() const
+    {
+        jassert (designer != nullptr);
+        return designer->getFftSize() / 2 + convolutions.getFirst()->getLatency();
+    }
+
+    /*
+     true when the FIRs follow these parameters or a design for them was queued,
+     false when the queue is full: call it again later.
+     */
+    bool update (const ChainHelpers::MonoChain& leftChain, const ChainHelpers::MonoChain& rightChain, const ChannelGroups::Groups& groups)
+    {
+        Design design { { getChainParameters (leftChain), getChainParameters (rightChain) }, groups };
+        if (hasDesign && design == currentDesign)
+        {
+            return true;
+        }
+
+        if (! designFifo.push (design))
+        {
+            return false;
+        }
+
+        currentDesign = design;
+        hasDesign = true;
+        workerPool->schedule (*this);
+        return true;
+    }
+
+    template <typename SampleType>
+    void process (juce::dsp::AudioBlock<SampleType>& block)
+    {
+        jassert (block.getNumChannels() <= numChannels);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            processPairs (block);
+        }
+        else
+        {
+            auto maxChunkSize = static_cast<size_t> (floatBuffer.getNumSamples());
+            for (size_t offset = 0; offset < block.getNumSamples(); offset += maxChunkSize)
+            {
+                auto subBlock = block.getSubBlock (offset, juce::jmin (maxChunkSize, block.getNumSamples() - offset));
+                auto floatBlock = juce::dsp::AudioBlock<float> (floatBuffer)
+                                      .getSubsetChannelBlock (0, subBlock.getNumChannels())
+                                      .getSubBlock (0, subBlock.getNumSamples());
+
+                copy (subBlock, floatBlock);
+                processPairs (floatBlock);
+                copy (floatBlock, subBlock);
+            }
+        }
+    }
+
+    /*
+     offline only, after prepare() and not on the audio thread: designs the FIRs for the
+     parameters of the chains, waits for the worker pool and for the Convolutions to load
+     them, and resets the Convolutions, so that the first block goes through the final FIRs
+     instead of crossfading from the previous ones. false if that takes more than 'timeoutMs'.
+     */
+    bool loadFirsAndWait (const ChainHelpers::MonoChain& leftChain,
+                          const ChainHelpers::MonoChain& rightChain,
+                          const ChannelGroups::Groups& groups,
+                          int timeoutMs)
+    {
+        jassert (designer != nullptr);
+        while (! update (leftChain, rightChain, groups))
+        {
+            workerPool->waitUntilIdle (*this);
+        }
+        workerPool->waitUntilIdle (*this);
+
+        // a Convolution picks up the FIR its background thread loaded when it processes a block
+        juce::AudioBuffer<float> silence (2, floatBuffer.getNumSamples());
+        const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32> (timeoutMs);
+        for (size_t pair = 0; pair < getNumPairs(); ++pair)
+        {
+            auto* convolution = convolutions[static_cast<int> (pair)];
+            while (convolution->getCurrentIRSize() != designer->getFftSize())
+            {
+                if (juce::Time::getMillisecondCounter() > deadline)
+                {
+                    return false;
+                }
+
+                silence.clear();
+                juce::dsp::AudioBlock<float> block (silence);
+                convolution->process (juce::dsp::ProcessContextReplacing<float> (block));
+                juce::Thread::sleep (1);
+            }
+        }
+
+        // also ends the crossfade to the new FIRs
+        reset();
+        return true;
+    }
+
+    // the parameters the chain is heading to, once its smoothing is over
+    static LinearPhaseFirDesign::ChainParameters getChainParameters (const ChainHelpers::MonoChain& chain)
+    {
+        return { chain.get<0>().getTargetParameters(),
+                 { chain.get<1>().getTargetParameters(),
+                   chain.get<2>().getTargetParameters(),
+                   chain.get<3>().getTargetParameters(),
+                   chain.get<4>().getTargetParameters(),
+                   chain.get<5>().getTargetParameters(),
+                   chain.get<6>().getTargetParameters() },
+                 chain.get<7>().getTargetParameters() };
+    }
+
+    // designs the FIRs for the latest parameters, older ones are skipped
+    void run() override
+    {
+        Design design;
+        bool gotDesign = false;
+        while (designFifo.pull (design))
+        {
+            gotDesign = true;
+        }
+
+        if (! gotDesign)
+        {
+            return;
+        }
+
+        const auto fftSize = designer->getFftSize();
+        juce::AudioBuffer<float> groupResponses (2, fftSize);
+        for (auto group : { Channel::LEFT, Channel::RIGHT })
+        {
+            auto index = static_cast<size_t> (group);
+            designer->design (design.parameters[index], sampleRate, groupResponses.getWritePointer (static_cast<int> (index)));
+        }
+
+        for (size_t pair = 0; pair < getNumPairs(); ++pair)
+        {
+            // the second channel of an odd pair doesn't exist, it gets a copy of the first one's FIR
+            auto first = pair * 2;
+            auto second = juce::jmin (first + 1, numChannels - 1);
+
+            juce::AudioBuffer<float> impulseResponse (2, fftSize);
+            impulseResponse.copyFrom (0, 0, groupResponses, static_cast<int> (design.groups[first]), 0, fftSize);
+            impulseResponse.copyFrom (1, 0, groupResponses, static_cast<int> (design.groups[second]), 0, fftSize);
+
+            convolutions[static_cast<int> (pair)]->loadImpulseResponse (std::move (impulseResponse),
+                                                                        sampleRate,
+                                                                        juce::dsp::Convolution::Stereo::yes,
+                                                                        juce::dsp::Convolution::Trim::no,
+                                                                        juce::dsp::Convolution::Normalise::no);
+        }
+    }
+
+private:
+    struct Design
+    {
+        Parameters parameters;
+        ChannelGroups::Groups groups {};
+
+        bool operator== (const Design& other) const
+        {
+            return parameters == other.parameters && groups == other.groups;
+        }
+    };
+
+    size_t getNumPairs() const
+    {
+        return (numChannels + 1) / 2;
+    }
+
+    void processPairs (juce::dsp::AudioBlock<float> block)
+    {
+        for (size_t first = 0; first < block.getNumChannels(); first += 2)
+        {
+            auto pairBlock = block.getSubsetChannelBlock (first, juce::jmin (static_cast<size_t> (2), block.getNumChannels() - first));
+            convolutions[static_cast<int> (first / 2)]->process (juce::dsp::ProcessContextReplacing<float> (pairBlock));
+        }
+    }
+
+    template <typename Source, typename Destination>
+    static void copy (const juce::dsp::AudioBlock<Source>& source, juce::dsp::AudioBlock<Destination>& destination)
+    {
+        for (size_t channel = 0; channel < source.getNumChannels(); ++channel)
+        {
+            auto* in = source.getChannelPointer (channel);
+            auto* out = destination.getChannelPointer (channel);
+            for (size_t i = 0; i < source.getNumSamples(); ++i)
+            {
+                out[i] = static_cast<Destination> (in[i]);
+            }
+        }
+    }
+
+    static const size_t FIFO_SIZE = 32;
+
+    // declared before the convolutions, which use it until they are destroyed
+    juce::dsp::ConvolutionMessageQueue messageQueue;
+    juce::OwnedArray<juce::dsp::Convolution> convolutions;
+    std::unique_ptr<LinearPhaseFirDesign::FirDesigner> designer;
+    juce::AudioBuffer<float> floatBuffer;
+    double sampleRate = 44100.0;
+    size_t numChannels = 2;
+
+    SpscRing<Design, FIFO_SIZE> designFifo;
+    Design currentDesign;
+    bool hasDesign = false;
+    juce::SharedResourcePointer<CoefficientWorkerPool> workerPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEngine)
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "data/FilterParameters.h"
+#include "utils/BatchCoefficientsMaker.h"
+#include "utils/MemoryFootprint.h"
+#include <JuceHeader.h>
+
+namespace LinearPhaseFirDesign
+{
+// the FIRs span about this long at every sample rate: 8192 samples at 44.1 and 48 kHz
+static const double FIR_LENGTH_IN_SECONDS = 0.17;
+
+// the parameters of the 8 bands of a MonoChain, in chain order
+struct ChainParameters
+{
+    HighCutLowCutParameters lowCut;
+    std::array<FilterParameters, 6> parametrics;
+    HighCutLowCutParameters highCut;
+};
+
+inline bool operator== (const ChainParameters& lhs, const ChainParameters& rhs)
+{
+    return lhs.lowCut == rhs.lowCut && lhs.parametrics == rhs.parametrics && lhs.highCut == rhs.highCut;
+}
+
+inline bool operator!= (const ChainParameters& lhs, const ChainParameters& rhs)
+{
+    return ! (lhs == rhs);
+}
+
+// 4 sections for each cut filter, 1 for each parametric band
+using ChainBatch = CoefficientsBatch<14, double>;
+
+// the sections of every band that isn't bypassed, in double precision
+inline void computeSections (ChainBatch& batch, const ChainParameters& chain)
+{
+    batch.clear();
+
+    if (! chain.lowCut.bypassed)
+    {
+        batch.addSections (chain.lowCut);
+    }
+
+    for (const auto& params : chain.parametrics)
+    {
+        if (! params.bypassed)
+        {
+            batch.addSections (params);
+        }
+    }
+
+    if (! chain.highCut.bypassed)
+    {
+        batch.addSections (chain.highCut);
+    }
+
+    batch.compute();
+}
+
+inline int getFftOrder (double sampleRate)
+{
+    auto numSamples = juce::nextPowerOfTwo (juce::roundToInt (sampleRate * FIR_LENGTH_IN_SECONDS));
+    return juce::roundToInt (std::log2 (numSamples));
+}
+
+/*
+ designs linear phase FIRs with the magnitude response of a chain, by frequency sampling:
+ - the magnitude of every band is sampled at the bins of an FFT, with zero phase,
+ - the inverse FFT gives the zero phase impulse response, centred on sample 0,
+ - which is rotated by half the FFT size and windowed (Blackman).
+ the FIR is symmetric around fftSize / 2, which is its latency.
+ allocates: it's meant to run on a worker thread.
+ */
+struct FirDesigner
+{
+    explicit FirDesigner (int fftOrder)
+        : fft (fftOrder), fftSize (1 << fftOrder), spectrum (static_cast<size_t> (2 * fftSize)), window (static_cast<size_t> (fftSize))
+    {
+        for (int n = 0; n < fftSize; ++n)
+        {
+            auto phase = juce::MathConstants<double>::twoPi * n / fftSize;
+            window[static_cast<size_t> (n)] = static_cast<float> (0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase));
+        }
+    }
+
+    int getFftSize() const
+    {
+        return fftSize;
+    }
+
+    // the tables of the FFT are not counted, see MemoryFootprint
+    size_t getMemoryFootprint() const
+    {
+        return sizeof (*this) + MemoryFootprint::getHeapBytes (spectrum) + MemoryFootprint::getHeapBytes (window);
+    }
+
+    // writes getFftSize() samples to 'impulseResponse'
+    void design (const ChainParameters& chain, double sampleRate, float* impulseResponse)
+    {
+        computeSections (batch, chain);
+
+        const auto numBins = fftSize / 2 + 1;
+        std::fill (spectrum.begin(), spectrum.end(), 0.0f);
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            auto frequency = bin * sampleRate / fftSize;
+            double magnitude = 1.0;
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                magnitude *= batch.getSection (i).getMagnitudeForFrequency (frequency, sampleRate);
+            }
+
+            spectrum[static_cast<size_t> (2 * bin)] = static_cast<float> (magnitude);
+        }
+
+        // juce scales the inverse transform by 1 / fftSize: the result is the impulse response as is
+        fft.performRealOnlyInverseTransform (spectrum.data());
+
+        const auto halfSize = fftSize / 2;
+        for (int n = 0; n < fftSize; ++n)
+        {
+            auto source = static_cast<size_t> ((n + halfSize) % fftSize);
+            impulseResponse[n] = spectrum[source] * window[static_cast<size_t> (n)];
+        }
+    }
+
+private:
+    juce::dsp::FFT fft;
+    int fftSize;
+    std::vector<float> spectrum;
+    std::vector<float> window;
+    ChainBatch batch;
+};
+} // namespace LinearPhaseFirDesign
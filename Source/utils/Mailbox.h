@@ -0,0 +1,55 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+ single producer / single consumer "latest value wins" hand-off, a triple buffer.
+ the producer writes into its own slot and swaps it with the middle one, the consumer
+ swaps its own slot with the middle one when it holds something new: both are wait free,
+ a single atomic exchange, and they never touch the same slot at the same time.
+ values the consumer didn't read before the next write are overwritten, nothing queues up.
+ */
+template <typename T>
+struct Mailbox
+{
+    static_assert (std::is_trivially_copyable_v<T>, "a slot is copied while the other thread may be reading another one");
+
+    // producer only, never fails
+    void write (const T& value) noexcept
+    {
+        slots[producerSlot] = value;
+        auto previous = middle.exchange (producerSlot | NEW_VALUE, std::memory_order_acq_rel);
+        producerSlot = previous & SLOT_MASK;
+    }
+
+    /*
+     consumer only, returns false (and leaves 'value' alone) when nothing was written since the last read.
+     the first load is relaxed: a consumer woken up by the producer must order it after
+     its wake-up itself (see CoefficientWorkerPool::schedule()).
+     */
+    bool read (T& value) noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & NEW_VALUE) == 0)
+        {
+            return false;
+        }
+
+        auto previous = middle.exchange (consumerSlot, std::memory_order_acq_rel);
+        consumerSlot = previous & SLOT_MASK;
+        value = slots[consumerSlot];
+        return true;
+    }
+
+private:
+    static constexpr uint32_t SLOT_MASK = 3;
+    static constexpr uint32_t NEW_VALUE = 4;
+
+    std::array<T, 3> slots {};
+    uint32_t producerSlot = 0;
+    uint32_t consumerSlot = 1;
+    // the index of the middle slot, with NEW_VALUE when the producer swapped it in since the consumer's last read
+    std::atomic<uint32_t> middle { 2 };
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/*
+ the bytes an instance holds, per subsystem: what its objects embed (sizeof) plus the
+ buffers they own on the heap. what juce allocates on its own behind its classes
+ (the Convolution engines, the FFT tables, the parameters...) is not counted.
+ the getMemoryFootprint() of a class returns its bytes the same way.
+ */
+struct MemoryFootprint
+{
+    struct Entry
+    {
+        juce::String subsystem;
+        size_t bytes = 0;
+    };
+
+    void add (const juce::String& subsystem, size_t bytes)
+    {
+        entries.push_back ({ subsystem, bytes });
+    }
+
+    const std::vector<Entry>& getEntries() const
+    {
+        return entries;
+    }
+
+    size_t getTotalBytes() const
+    {
+        size_t total = 0;
+        for (const auto& entry : entries)
+        {
+            total += entry.bytes;
+        }
+        return total;
+    }
+
+    // one line per subsystem and the total, in KiB
+    juce::String toString() const
+    {
+        juce::String text;
+        for (const auto& entry : entries)
+        {
+            text << entry.subsystem << ": " << toKibibytes (entry.bytes) << " KiB\n";
+        }
+        text << "total: " << toKibibytes (getTotalBytes()) << " KiB\n";
+        return text;
+    }
+
+    // the heap buffer of an object, nothing for the types that don't own one
+    template <typename T>
+    static size_t getHeapBytes (const T&)
+    {
+        return 0;
+    }
+
+    template <typename T>
+    static size_t getHeapBytes (const std::vector<T>& vector)
+    {
+        return vector.capacity() * sizeof (T);
+    }
+
+    template <typename T>
+    static size_t getHeapBytes (const juce::AudioBuffer<T>& buffer)
+    {
+        return static_cast<size_t> (buffer.getNumChannels()) * static_cast<size_t> (buffer.getNumSamples()) * sizeof (T);
+    }
+
+private:
+    static juce::String toKibibytes (size_t bytes)
+    {
+        return juce::String (static_cast<double> (bytes) / 1024.0, 1);
+    }
+
+    std::vector<Entry> entries;
+};
@@ -29,4 +29,22 @@ struct MidSideProcessor
             rightWriter[i] = side;
         }
     }
+
+    /*
+     in place, on a chunk that is about to be filtered or just was: the matrix is its own
+     inverse, the same call encodes and decodes.
+     */
+    template <typename SampleType>
+    static void process (SampleType* left, SampleType* right, size_t numSamples) noexcept
+    {
+        const auto correctiveGain = static_cast<SampleType> (juce::Decibels::decibelsToGain (-3.0f));
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto l = left[i];
+            auto r = right[i];
+            left[i] = (l + r) * correctiveGain;
+            right[i] = (l - r) * correctiveGain;
+        }
+    }
 };
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstddef>
+
+/*
+ bounded lock free multi producer / multi consumer queue (Dmitry Vyukov's design).
+ every cell carries a sequence number telling producers and consumers whether
+ it's their turn, so push and pop are a single CAS on the uncontended path.
+ Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+struct MpmcQueue
+{
+    static_assert (Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    MpmcQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            cells[i].sequence.store (i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push (const T& item)
+    {
+        Cell* cell = nullptr;
+        auto position = enqueuePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell = &cells[position & MASK];
+            auto sequence = cell->sequence.load (std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position);
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                position = enqueuePosition.load (std::memory_order_relaxed);
+            }
+        }
+
+        cell->item = item;
+        cell->sequence.store (position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop (T& item)
+    {
+        Cell* cell = nullptr;
+        auto position = dequeuePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell = &cells[position & MASK];
+            auto sequence = cell->sequence.load (std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position + 1);
+
+            if (difference == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                position = dequeuePosition.load (std::memory_order_relaxed);
+            }
+        }
+
+        item = cell->item;
+        cell->sequence.store (position + MASK + 1, std::memory_order_release);
+        return true;
+    }
+
+    // only a hint when other threads are pushing or popping
+    bool isEmpty() const
+    {
+        return enqueuePosition.load (std::memory_order_relaxed) == dequeuePosition.load (std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    std::array<Cell, Capacity> cells;
+    alignas (CACHE_LINE_SIZE) std::atomic<size_t> enqueuePosition { 0 };
+    alignas (CACHE_LINE_SIZE) std::atomic<size_t> dequeuePosition { 0 };
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "utils/ChannelGroups.h"
+#include "utils/LaneChain.h"
+#include "utils/MemoryFootprint.h"
+#include <JuceHeader.h>
+
+/*
+ the biquad engine for any channel count up to ChannelGroups::MAX_CHANNELS.
+ a stereo bus goes through a LaneChain<2>, as it always did. other buses are
+ split into groups of LANES_PER_GROUP consecutive channels, each group is one
+ LaneChain: its channels are filtered in the SIMD lanes of a single pass, whatever
+ parameter set each of them follows.
+ lanes follow the channel order, so a channel keeps its filter state when it
+ moves to another parameter set.
+ the last group is padded with scratch channels, which mirror the first lane
+ of the group and are cleared before every pass.
+ */
+template <typename FloatType>
+struct MultichannelChain
+{
+    using Chains = std::array<ChainHelpers::MonoChain*, ChannelGroups::MAX_CHANNELS>;
+
+    static const size_t LANES_PER_GROUP = 4;
+    static const size_t MAX_GROUPS = ChannelGroups::MAX_CHANNELS / LANES_PER_GROUP;
+
+    // not on the audio thread
+    void prepare (int maximumBlockSize)
+    {
+        padding.setSize (static_cast<int> (LANES_PER_GROUP - 1), juce::jmax (1, maximumBlockSize));
+        reset();
+    }
+
+    void reset()
+    {
+        stereoChain.reset();
+        for (auto& group : groups)
+        {
+            group.reset();
+        }
+    }
+
+    void setParallelFormEnabled (bool shouldBeEnabled)
+    {
+        stereoChain.setParallelFormEnabled (shouldBeEnabled);
+        for (auto& group : groups)
+        {
+            group.setParallelFormEnabled (shouldBeEnabled);
+        }
+    }
+
+    // 'chains' holds the chain of every channel, only the first 'numChannels' are used
+    void update (const Chains& chains, size_t numChannels, size_t rampLength = 0)
+    {
+        jassert (numChannels > 0 && numChannels <= ChannelGroups::MAX_CHANNELS);
+
+        if (numChannels == 2)
+        {
+            stereoChain.update ({ chains[0], chains[1] }, rampLength);
+            return;
+        }
+
+        for (size_t group = 0; group < getNumGroups (numChannels); ++group)
+        {
+            typename LaneChain<LANES_PER_GROUP, FloatType>::Chains groupChains;
+            for (size_t lane = 0; lane < LANES_PER_GROUP; ++lane)
+            {
+                auto channel = group * LANES_PER_GROUP + lane;
+                groupChains[lane] = channel < numChannels ? chains[channel] : groupChains[0];
+            }
+            groups[group].update (groupChains, rampLength);
+        }
+    }
+
+    void process (const juce::dsp::AudioBlock<FloatType>& block) noexcept
+    {
+        auto numChannels = block.getNumChannels();
+        jassert (numChannels > 0 && numChannels <= ChannelGroups::MAX_CHANNELS);
+
+        if (numChannels == 2)
+        {
+            stereoChain.process (block);
+            return;
+        }
+
+        // the scratch channels hold at most one block of the size prepare() was called with
+        auto maxChunkSize = static_cast<size_t> (padding.getNumSamples());
+        if (maxChunkSize == 0)
+        {
+            jassertfalse; // prepare() first
+            return;
+        }
+
+        for (size_t offset = 0; offset < block.getNumSamples(); offset += maxChunkSize)
+        {
+            auto numSamples = juce::jmin (maxChunkSize, block.getNumSamples() - offset);
+
+            for (size_t group = 0; group < getNumGroups (numChannels); ++group)
+            {
+                std::array<FloatType*, LANES_PER_GROUP> channels;
+                for (size_t lane = 0; lane < LANES_PER_GROUP; ++lane)
+                {
+                    auto channel = group * LANES_PER_GROUP + lane;
+                    if (channel < numChannels)
+                    {
+                        channels[lane] = block.getChannelPointer (channel) + offset;
+                    }
+                    else
+                    {
+                        auto scratchChannel = static_cast<int> (lane - 1);
+                        padding.clear (scratchChannel, 0, static_cast<int> (numSamples));
+                        channels[lane] = padding.getWritePointer (scratchChannel);
+                    }
+                }
+
+                groups[group].process (channels.data(), numSamples);
+            }
+        }
+    }
+
+    size_t getMemoryFootprint() const
+    {
+        return sizeof (*this) + MemoryFootprint::getHeapBytes (padding);
+    }
+
+private:
+    static size_t getNumGroups (size_t numChannels)
+    {
+        return (numChannels + LANES_PER_GROUP - 1) / LANES_PER_GROUP;
+    }
+
+    LaneChain<2, FloatType> stereoChain;
+    std::array<LaneChain<LANES_PER_GROUP, FloatType>, MAX_GROUPS> groups;
+    juce::AudioBuffer<FloatType> padding;
+};
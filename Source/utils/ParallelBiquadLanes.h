@@ -0,0 +1,141 @@
+#pragma once
+
+#include "utils/BiquadSection.h"
+#include <JuceHeader.h>
+
+/*
+ runs the parallel form of a cascade (see ParallelFormConverter) over NumLanes channels:
+   y = k x + sum_j section_j (x)
+ the sections are independent from each other and their b0 is 0, so within a sample
+ no section waits for another one. every channel is processed on its own with the
+ sections side by side, padded to NUM_SECTION_LANES whole registers; unused sections
+ are all zero and output nothing.
+
+ section j of a channel keeps its state across coefficient updates, the same way the
+ slots of BiquadLaneCascade do. the coefficients jump to new values, they don't ramp.
+ */
+template <typename FloatType, size_t NumLanes, size_t MaxSections>
+struct ParallelBiquadLanes
+{
+    static constexpr size_t ALIGNMENT = 32;
+
+    static constexpr size_t getNumSectionLanes()
+    {
+        size_t numSectionLanes = 1;
+        while (numSectionLanes < MaxSections)
+        {
+            numSectionLanes *= 2;
+        }
+        return numSectionLanes;
+    }
+
+    // a power of two, so the outputs of the sections add up pairwise
+    static constexpr size_t NUM_SECTION_LANES = getNumSectionLanes();
+
+    void reset()
+    {
+        for (auto& channel : channels)
+        {
+            channel.s1.fill (FloatType (0));
+            channel.s2.fill (FloatType (0));
+        }
+    }
+
+    // b0 of the sections is ignored, it's 0 in the parallel form
+    void setSections (size_t lane, FloatType directGain, const std::array<BiquadSection<FloatType>, MaxSections>& sections)
+    {
+        jassert (lane < NumLanes);
+        auto& channel = channels[lane];
+        channel.directGain = directGain;
+
+        for (size_t j = 0; j < MaxSections; ++j)
+        {
+            jassert (sections[j].b0 == FloatType (0));
+            channel.b1[j] = sections[j].b1;
+            channel.b2[j] = sections[j].b2;
+            channel.a1[j] = sections[j].a1;
+            channel.a2[j] = sections[j].a2;
+        }
+    }
+
+    void getState (size_t section, size_t lane, FloatType& s1, FloatType& s2) const
+    {
+        jassert (section < MaxSections && lane < NumLanes);
+        s1 = channels[lane].s1[section];
+        s2 = channels[lane].s2[section];
+    }
+
+    void setState (size_t section, size_t lane, FloatType s1, FloatType s2)
+    {
+        jassert (section < MaxSections && lane < NumLanes);
+        channels[lane].s1[section] = s1;
+        channels[lane].s2[section] = s2;
+    }
+
+    void process (FloatType* const* data, size_t numSamples) noexcept
+    {
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            processChannel (channels[lane], data[lane], numSamples);
+        }
+    }
+
+private:
+    using SectionArray = std::array<FloatType, NUM_SECTION_LANES>;
+
+    struct alignas (ALIGNMENT) Channel
+    {
+        SectionArray b1 {}, b2 {}, a1 {}, a2 {};
+        SectionArray s1 {}, s2 {};
+        FloatType directGain = FloatType (1);
+    };
+
+    /*
+     one loop over the sections per sample, the outputs are added up as a tree.
+     */
+    static void processChannel (Channel& channel, FloatType* data, size_t numSamples) noexcept
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = data[i];
+            alignas (ALIGNMENT) SectionArray output;
+
+            for (size_t j = 0; j < NUM_SECTION_LANES; ++j)
+            {
+                // b0 is 0: the output of a section is its first state
+                output[j] = channel.s1[j];
+                channel.s1[j] = channel.b1[j] * x - channel.a1[j] * output[j] + channel.s2[j];
+                channel.s2[j] = channel.b2[j] * x - channel.a2[j] * output[j];
+            }
+
+            data[i] = channel.directGain * x + addUp<NUM_SECTION_LANES / 2> (output);
+        }
+
+        for (size_t j = 0; j < NUM_SECTION_LANES; ++j)
+        {
+            juce::dsp::util::snapToZero (channel.s1[j]);
+            juce::dsp::util::snapToZero (channel.s2[j]);
+        }
+    }
+
+    // adds the upper half onto the lower one until a single value is left
+    template <size_t Width>
+    static FloatType addUp (SectionArray& values) noexcept
+    {
+        for (size_t j = 0; j < Width; ++j)
+        {
+            values[j] += values[j + Width];
+        }
+
+        if constexpr (Width > 1)
+        {
+            return addUp<Width / 2> (values);
+        }
+        else
+        {
+            return values[0];
+        }
+    }
+
+    std::array<Channel, NumLanes> channels;
+};
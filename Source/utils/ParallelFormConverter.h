@@ -0,0 +1,333 @@
+#pragma once
+
+#include "utils/BiquadSection.h"
+#include <JuceHeader.h>
+#include <complex>
+
+/*
+ converts a cascade of biquad sections into the equivalent sum of parallel sections
+   H(z) = k + sum_j (b1_j z^-1 + b2_j z^-2) / (1 + a1_j z^-1 + a2_j z^-2)
+ by partial fraction expansion. parallel section j keeps the poles of cascade section j,
+ so both forms have the same denominators section by section, and a parallel section
+ follows its cascade section smoothly while the parameters move.
+
+ the poles are the roots of the section denominators, only the residues are computed:
+   R_i = N(p_i) / prod_{j != i} (p_i - p_j)
+ with the numerator and the denominators written as polynomials in z (k is the product
+ of the b0s). poles that are close to each other make the residues large, and the
+ parallel sections then cancel each other out: canConvert() rejects cascades whose
+ cancellation would amplify the rounding error of the processing precision beyond
+ MAX_RELATIVE_ERROR.
+
+ the same expansion maps the state of one form onto the other: the zero input responses
+ of both are sums of the same modes, so switching between the forms doesn't click.
+ identity sections (e.g. unused slots) are pure gains without poles, and may sit
+ anywhere in the cascade. everything is computed in double precision.
+ */
+template <size_t MaxSections>
+struct ParallelFormConverter
+{
+    using Sections = std::array<BiquadSection<double>, MaxSections>;
+
+    // -100 dB relative to the input
+    static constexpr double MAX_RELATIVE_ERROR = 1.0e-5;
+
+    // the transposed direct form II state of a section
+    struct State
+    {
+        double s1 = 0.0;
+        double s2 = 0.0;
+    };
+
+    using States = std::array<State, MaxSections>;
+
+    /*
+     expands the cascade and returns whether the parallel form is usable when processed
+     with a precision of 'epsilon'. it isn't when a section is unstable or when the
+     cancellation between the parallel sections is too large.
+     */
+    bool convert (const Sections& cascadeSections, double epsilon)
+    {
+        valid = false;
+        for (size_t j = 0; j < MaxSections; ++j)
+        {
+            if (! setSection (sections[j], cascadeSections[j]))
+            {
+                return false;
+            }
+        }
+
+        directGain = 1.0;
+        for (const auto& section : sections)
+        {
+            directGain *= section.coefficients.b0;
+        }
+
+        auto amplification = std::abs (directGain);
+        for (size_t j = 0; j < MaxSections; ++j)
+        {
+            const auto& section = sections[j];
+            std::array<Complex, 2> numerators {};
+
+            for (size_t i = 0; i < section.order; ++i)
+            {
+                auto pole = section.poles[i];
+                numerators[i] = evaluateNumerator (section, pole) * getTransferFunctionBefore (j, pole) * getTransferFunctionAfter (j, pole);
+
+                auto residue = numerators[i] * getOwnDenominatorInverse (section, i);
+                amplification += std::abs (residue) / (1.0 - std::abs (pole));
+            }
+
+            auto own = solveOwnNumerator (section, numerators);
+            parallelSections[j] = { 0.0, own.s1, own.s2, section.coefficients.a1, section.coefficients.a2 };
+        }
+
+        valid = std::isfinite (amplification) && amplification * epsilon <= MAX_RELATIVE_ERROR;
+        return valid;
+    }
+
+    bool canConvert() const
+    {
+        return valid;
+    }
+
+    double getDirectGain() const
+    {
+        jassert (valid);
+        return directGain;
+    }
+
+    // b0 of every parallel section is 0: its output only depends on its state
+    const Sections& getParallelSections() const
+    {
+        jassert (valid);
+        return parallelSections;
+    }
+
+    // the parallel state that continues the zero input response of the cascade in 'cascadeStates'
+    States getParallelState (const States& cascadeStates) const
+    {
+        jassert (valid);
+        States parallelStates {};
+
+        for (size_t j = 0; j < MaxSections; ++j)
+        {
+            const auto& section = sections[j];
+            std::array<Complex, 2> numerators {};
+
+            for (size_t i = 0; i < section.order; ++i)
+            {
+                auto pole = section.poles[i];
+                auto before = accumulateStatesBefore (j, pole, cascadeStates);
+                auto own = evaluateStateNumerator (section, cascadeStates[j], pole);
+                numerators[i] = getTransferFunctionAfter (j, pole) * (own + evaluateNumerator (section, pole) * before);
+            }
+
+            parallelStates[j] = solveOwnNumerator (section, numerators);
+        }
+
+        return parallelStates;
+    }
+
+    // the cascade state that continues the zero input response of the parallel form in 'parallelStates'
+    States getCascadeState (const States& parallelStates) const
+    {
+        jassert (valid);
+        States cascadeStates {};
+
+        // the modes of section j only depend on the states of the sections up to j
+        for (size_t j = 0; j < MaxSections; ++j)
+        {
+            const auto& section = sections[j];
+            std::array<Complex, 2> numerators {};
+
+            for (size_t i = 0; i < section.order; ++i)
+            {
+                auto pole = section.poles[i];
+                auto before = accumulateStatesBefore (j, pole, cascadeStates);
+                auto parallel = evaluateStateNumerator (section, parallelStates[j], pole);
+                numerators[i] = parallel / getTransferFunctionAfter (j, pole) - evaluateNumerator (section, pole) * before;
+            }
+
+            auto state = solveOwnNumerator (section, numerators);
+            if (std::isfinite (state.s1) && std::isfinite (state.s2))
+            {
+                cascadeStates[j] = state;
+            }
+        }
+
+        return cascadeStates;
+    }
+
+private:
+    using Complex = std::complex<double>;
+
+    struct Section
+    {
+        BiquadSection<double> coefficients;
+        // 0 for a pure gain, 1 for a first order section
+        size_t order = 0;
+        std::array<Complex, 2> poles {};
+    };
+
+    static bool setSection (Section& section, const BiquadSection<double>& coefficients)
+    {
+        section.coefficients = coefficients;
+        section.order = 2;
+
+        if (coefficients.b2 == 0.0 && coefficients.a2 == 0.0)
+        {
+            section.order = coefficients.b1 == 0.0 && coefficients.a1 == 0.0 ? 0 : 1;
+        }
+
+        if (section.order == 1)
+        {
+            section.poles[0] = -coefficients.a1;
+        }
+        else if (section.order == 2)
+        {
+            auto a1 = coefficients.a1;
+            auto a2 = coefficients.a2;
+            auto discriminant = a1 * a1 - 4.0 * a2;
+
+            if (discriminant < 0.0)
+            {
+                section.poles[0] = Complex (-0.5 * a1, 0.5 * std::sqrt (-discriminant));
+                section.poles[1] = std::conj (section.poles[0]);
+            }
+            else
+            {
+                // the larger root first, the other one from the product of the roots without cancellation
+                auto root = -0.5 * (a1 + std::copysign (std::sqrt (discriminant), a1));
+                section.poles[0] = root;
+                section.poles[1] = root != 0.0 ? a2 / root : 0.0;
+            }
+        }
+
+        for (size_t i = 0; i < section.order; ++i)
+        {
+            if (! (std::abs (section.poles[i]) < 1.0))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // numerator and denominator of a section as polynomials in z, with the degree of the section
+    static Complex evaluateNumerator (const Section& section, Complex z)
+    {
+        const auto& c = section.coefficients;
+        switch (section.order)
+        {
+            case 0:
+                return c.b0;
+            case 1:
+                return c.b0 * z + c.b1;
+            default:
+                return (c.b0 * z + c.b1) * z + c.b2;
+        }
+    }
+
+    static Complex evaluateDenominator (const Section& section, Complex z)
+    {
+        const auto& c = section.coefficients;
+        switch (section.order)
+        {
+            case 0:
+                return 1.0;
+            case 1:
+                return z + c.a1;
+            default:
+                return (z + c.a1) * z + c.a2;
+        }
+    }
+
+    // the numerator of the z transform of a section's zero input response, divided by z
+    static Complex evaluateStateNumerator (const Section& section, const State& state, Complex z)
+    {
+        switch (section.order)
+        {
+            case 0:
+                return 0.0;
+            case 1:
+                return state.s1;
+            default:
+                return state.s1 * z + state.s2;
+        }
+    }
+
+    // 1 / (p_i - p_other) for the pole i of a second order section
+    static Complex getOwnDenominatorInverse (const Section& section, size_t poleIndex)
+    {
+        if (section.order < 2)
+        {
+            return 1.0;
+        }
+        return 1.0 / (section.poles[poleIndex] - section.poles[1 - poleIndex]);
+    }
+
+    /*
+     the state (or the b1 and b2 of a parallel section) whose numerator s1 z + s2 takes
+     the given values at the poles of 'section'. the values are complex conjugates or
+     real, so are the poles, and the solution is real.
+     */
+    static State solveOwnNumerator (const Section& section, const std::array<Complex, 2>& values)
+    {
+        switch (section.order)
+        {
+            case 0:
+                return {};
+            case 1:
+                return { values[0].real(), 0.0 };
+            default:
+            {
+                auto s1 = (values[0] - values[1]) / (section.poles[0] - section.poles[1]);
+                auto s2 = values[0] - s1 * section.poles[0];
+                return { s1.real(), s2.real() };
+            }
+        }
+    }
+
+    Complex getTransferFunctionBefore (size_t j, Complex z) const
+    {
+        Complex product = 1.0;
+        for (size_t m = 0; m < j; ++m)
+        {
+            product *= evaluateNumerator (sections[m], z) / evaluateDenominator (sections[m], z);
+        }
+        return product;
+    }
+
+    Complex getTransferFunctionAfter (size_t j, Complex z) const
+    {
+        Complex product = 1.0;
+        for (size_t m = j + 1; m < MaxSections; ++m)
+        {
+            product *= evaluateNumerator (sections[m], z) / evaluateDenominator (sections[m], z);
+        }
+        return product;
+    }
+
+    /*
+     the zero input responses of the sections before j as they reach section j, at z:
+     sum_k (s1_k z + s2_k) / D_k(z) * prod_{k < m < j} H_m(z)
+     */
+    Complex accumulateStatesBefore (size_t j, Complex z, const States& states) const
+    {
+        Complex sum = 0.0;
+        for (size_t k = 0; k < j; ++k)
+        {
+            const auto& section = sections[k];
+            auto denominator = evaluateDenominator (section, z);
+            sum = sum * evaluateNumerator (section, z) / denominator + evaluateStateNumerator (section, states[k], z) / denominator;
+        }
+        return sum;
+    }
+
+    std::array<Section, MaxSections> sections {};
+    Sections parallelSections {};
+    double directGain = 1.0;
+    bool valid = false;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "utils/AnalyzerProperties.h"
+#include "utils/ChannelGroups.h"
+#include "utils/EqParam.h"
+#include "utils/FilterParam.h"
+#include <JuceHeader.h>
+
+/*
+ the raw values of every parameter the processor reads, resolved once when it is
+ constructed: the audio thread reads them through this flat table of atomics,
+ without building names or looking anything up.
+ the filter parameters are indexed by band, channel and FilterInfo::FilterParam.
+ a band only has the parameters of its kind (slope for the cut filters, gain for
+ the others): the other entries are null.
+
+ the table also keeps track of what changed: a listener per band sets the bit of
+ its band in a single atomic word, the mode and channel group parameters set the
+ CHANNEL_GROUPS bit along with every band, as they change what each chain follows.
+ consumeChanges() hands the bits over to the audio thread, which only re-reads the
+ bands that changed. while nothing does, that's a single atomic load per block.
+ the listeners of the value tree are called once the raw value was stored, a bit
+ is never consumed before its value can be read.
+ */
+struct ParameterTable
+{
+    static const size_t NUM_BANDS = 8;
+    static const size_t NUM_CHANNELS = 2;
+    // every FilterInfo::FilterParam, up to SLOPE
+    static const size_t NUM_FILTER_PARAMS = static_cast<size_t> (FilterInfo::FilterParam::SLOPE) + 1;
+
+    static const uint32_t ALL_BANDS = (1u << NUM_BANDS) - 1;
+    static const uint32_t CHANNEL_GROUPS = 1u << NUM_BANDS;
+    static const uint32_t EVERYTHING = ALL_BANDS | CHANNEL_GROUPS;
+
+    static uint32_t getBandMask (size_t band) noexcept
+    {
+        jassert (band < NUM_BANDS);
+        return 1u << band;
+    }
+
+    explicit ParameterTable (juce::AudioProcessorValueTreeState& apvtsToUse) : apvts (apvtsToUse)
+    {
+        for (size_t band = 0; band < NUM_BANDS; ++band)
+        {
+            for (auto channel : { Channel::LEFT, Channel::RIGHT })
+            {
+                for (size_t param = 0; param < NUM_FILTER_PARAMS; ++param)
+                {
+                    auto filterParam = static_cast<FilterInfo::FilterParam> (param);
+                    auto name = FilterInfo::getParameterName (static_cast<int> (band), channel, filterParam);
+                    auto* value = apvts.getRawParameterValue (name);
+                    filterParameters[getIndex (band, channel, filterParam)] = value;
+                    if (value != nullptr)
+                    {
+                        listen (name, band);
+                    }
+                }
+            }
+        }
+
+        for (size_t channel = 0; channel < ChannelGroups::MAX_CHANNELS; ++channel)
+        {
+            channelGroups[channel] = get (apvts, ChannelGroups::getParameterName (channel));
+            listen (ChannelGroups::getParameterName (channel), NUM_BANDS);
+        }
+
+        eqMode = get (apvts, "eq_mode");
+        listen ("eq_mode", NUM_BANDS);
+        filterEngine = get (apvts, "filter_engine");
+        coefficientInterpolation = get (apvts, "coefficient_interpolation");
+        inputGain = get (apvts, "input_gain");
+        outputGain = get (apvts, "output_gain");
+
+        const auto& analyzerParams = AnalyzerProperties::GetAnalyzerParams();
+        analyzerEnabled = get (apvts, analyzerParams.at (AnalyzerProperties::ParamNames::EnableAnalyzer));
+        analyzerPoints = get (apvts, analyzerParams.at (AnalyzerProperties::ParamNames::AnalyzerPoints));
+        analyzerProcessingMode = get (apvts, analyzerParams.at (AnalyzerProperties::ParamNames::AnalyzerProcessingMode));
+    }
+
+    ~ParameterTable()
+    {
+        for (const auto& [name, listener] : registrations)
+        {
+            apvts.removeParameterListener (name, listener);
+        }
+    }
+
+    // what changed since the last call, as band masks and CHANNEL_GROUPS. the bits are cleared
+    uint32_t consumeChanges() noexcept
+    {
+        if (changes.load (std::memory_order_relaxed) == 0)
+        {
+            return 0;
+        }
+
+        return changes.exchange (0, std::memory_order_acquire);
+    }
+
+    // after a change the listeners don't see, the sample rate or the channel layout
+    void markEverythingChanged() noexcept
+    {
+        changes.fetch_or (EVERYTHING, std::memory_order_release);
+    }
+
+    float getFilterParameter (int filterIndex, Channel channel, FilterInfo::FilterParam param) const noexcept
+    {
+        auto* value = filterParameters[getIndex (static_cast<size_t> (filterIndex), channel, param)];
+        jassert (value != nullptr); // this band doesn't have that parameter
+        return value->load();
+    }
+
+    EqMode getEqMode() const noexcept
+    {
+        return static_cast<EqMode> (eqMode->load());
+    }
+
+    FilterEngine getFilterEngine() const noexcept
+    {
+        return static_cast<FilterEngine> (filterEngine->load());
+    }
+
+    bool isCoefficientInterpolationEnabled() const noexcept
+    {
+        return coefficientInterpolation->load() > 0.5f;
+    }
+
+    float getInputGainDecibels() const noexcept
+    {
+        return inputGain->load();
+    }
+
+    float getOutputGainDecibels() const noexcept
+    {
+        return outputGain->load();
+    }
+
+    ChannelGroups::Assignment getChannelGroupAssignment (size_t channel) const noexcept
+    {
+        jassert (channel < ChannelGroups::MAX_CHANNELS);
+        return static_cast<ChannelGroups::Assignment> (channelGroups[channel]->load());
+    }
+
+    bool isAnalyzerEnabled() const noexcept
+    {
+        return analyzerEnabled->load() > 0.5f;
+    }
+
+    float getAnalyzerPoints() const noexcept
+    {
+        return analyzerPoints->load();
+    }
+
+    AnalyzerProperties::ProcessingModes getAnalyzerProcessingMode() const noexcept
+    {
+        return static_cast<AnalyzerProperties::ProcessingModes> (analyzerProcessingMode->load());
+    }
+
+private:
+    struct ChangeListener : juce::AudioProcessorValueTreeState::Listener
+    {
+        void parameterChanged (const juce::String&, float) override
+        {
+            changes->fetch_or (mask, std::memory_order_release);
+        }
+
+        std::atomic<uint32_t>* changes = nullptr;
+        uint32_t mask = 0;
+    };
+
+    // 'band' is NUM_BANDS for the parameters that change every band
+    void listen (const juce::String& name, size_t band)
+    {
+        auto& listener = band < NUM_BANDS ? bandListeners[band] : channelGroupsListener;
+        listener.changes = &changes;
+        listener.mask = band < NUM_BANDS ? getBandMask (band) : EVERYTHING;
+
+        apvts.addParameterListener (name, &listener);
+        registrations.emplace_back (name, &listener);
+    }
+
+    static size_t getIndex (size_t band, Channel channel, FilterInfo::FilterParam param) noexcept
+    {
+        jassert (band < NUM_BANDS);
+        return (band * NUM_CHANNELS + static_cast<size_t> (channel)) * NUM_FILTER_PARAMS + static_cast<size_t> (param);
+    }
+
+    static std::atomic<float>* get (juce::AudioProcessorValueTreeState& apvts, const juce::String& name)
+    {
+        auto* value = apvts.getRawParameterValue (name);
+        jassert (value != nullptr);
+        return value;
+    }
+
+    std::array<std::atomic<float>*, NUM_BANDS * NUM_CHANNELS * NUM_FILTER_PARAMS> filterParameters {};
+    std::array<std::atomic<float>*, ChannelGroups::MAX_CHANNELS> channelGroups {};
+    std::atomic<float>* eqMode = nullptr;
+    std::atomic<float>* filterEngine = nullptr;
+    std::atomic<float>* coefficientInterpolation = nullptr;
+    std::atomic<float>* inputGain = nullptr;
+    std::atomic<float>* outputGain = nullptr;
+    std::atomic<float>* analyzerEnabled = nullptr;
+    std::atomic<float>* analyzerPoints = nullptr;
+    std::atomic<float>* analyzerProcessingMode = nullptr;
+
+    juce::AudioProcessorValueTreeState& apvts;
+    std::atomic<uint32_t> changes { EVERYTHING };
+    std::array<ChangeListener, NUM_BANDS> bandListeners;
+    ChangeListener channelGroupsListener;
+    std::vector<std::pair<juce::String, ChangeListener*>> registrations;
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterTable)
+};
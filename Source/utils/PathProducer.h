@@ -146,6 +146,14 @@ struct PathProducer : juce::Thread
         maxDecibels = maxDb;
     }
 
+    // the points of the paths are not counted, see MemoryFootprint
+    size_t getMemoryFootprint() const
+    {
+        return sizeof (*this) - sizeof (fftDataGenerator) - sizeof (pathGenerator) + fftDataGenerator.getMemoryFootprint()
+               + pathGenerator.getMemoryFootprint() + MemoryFootprint::getHeapBytes (renderData)
+               + MemoryFootprint::getHeapBytes (bufferForGenerator);
+    }
+
     void changeSampleRate (double sr)
     {
         pauseThread();
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "data/FilterParameters.h"
+#include "utils/BatchCoefficientsMaker.h"
+#include "utils/BiquadSection.h"
+#include <JuceHeader.h>
+
+/*
+ the coefficients of a band, by value: up to MaxSections biquad sections (one for the
+ parametric bands, four for the cut filters) and how many of them are used.
+ records are trivially copyable, they go through a Mailbox from the coefficient workers
+ to the audio thread without allocating, freeing or counting references.
+ */
+template <size_t MaxSections>
+struct SectionRecord
+{
+    static const size_t MAX_SECTIONS = MaxSections;
+
+    std::array<BiquadSection<float>, MaxSections> sections {};
+    size_t numSections = 0;
+
+    double getMagnitudeForFrequency (double frequency, double sampleRate) const
+    {
+        double magnitude = 1.0;
+        for (size_t i = 0; i < numSections; ++i)
+        {
+            magnitude *= sections[i].getMagnitudeForFrequency (frequency, sampleRate);
+        }
+        return magnitude;
+    }
+};
+
+static_assert (std::is_trivially_copyable_v<SectionRecord<1>> && std::is_trivially_copyable_v<SectionRecord<4>>);
+
+/*
+ the SectionRecord counterpart of CoefficientsMaker: the sections are computed in double
+ precision on the stack, by the formulas of juce::dsp::IIR::Coefficients (see CoefficientsBatch),
+ and rounded to float.
+ */
+struct SectionRecordMaker
+{
+    SectionRecordMaker() = delete;
+    ~SectionRecordMaker() = delete;
+
+    static SectionRecord<1> make (const FilterParameters& params)
+    {
+        return makeRecord<1> (params);
+    }
+
+    static SectionRecord<4> make (const HighCutLowCutParameters& params)
+    {
+        return makeRecord<4> (params);
+    }
+
+private:
+    template <size_t MaxSections, typename ParamType>
+    static SectionRecord<MaxSections> makeRecord (const ParamType& params)
+    {
+        CoefficientsBatch<MaxSections, double> batch;
+        batch.addSections (params);
+        batch.compute();
+
+        SectionRecord<MaxSections> record;
+        record.numSections = batch.size();
+        for (size_t i = 0; i < record.numSections; ++i)
+        {
+            record.sections[i] = BiquadSection<float>::fromSection (batch.getSection (i));
+        }
+        return record;
+    }
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "utils/TailLength.h"
+#include <JuceHeader.h>
+
+/*
+ puts an instance to sleep while its track is silent.
+ shouldSkip() looks at every input block: digital silence, exact zeros, counts towards
+ sleep and anything else wakes the instance up.
+ after a silent block was processed, update() looks at the output: once the input has
+ been silent for at least the tail of the filters (see TailLength), the latency included,
+ and the output is below TailLength::SILENCE_FLOOR, the following silent blocks can be
+ skipped: their output is their input, zeros.
+ the output of a single block isn't enough on its own: a resonant band still ringing
+ can cross zero within a short block. what the tail leaves in the filter state is below
+ the floor, the caller clears it when update() puts the instance to sleep.
+ */
+struct SilenceDetector
+{
+    void reset()
+    {
+        sleeping = false;
+        inputSilent = false;
+        numSilentSamples = 0;
+    }
+
+    bool isSleeping() const
+    {
+        return sleeping;
+    }
+
+    // before processing 'input': true when it doesn't need any
+    template <typename SampleType>
+    bool shouldSkip (const juce::dsp::AudioBlock<SampleType>& input) noexcept
+    {
+        inputSilent = isSilent (input);
+        if (! inputSilent)
+        {
+            sleeping = false;
+            numSilentSamples = 0;
+            return false;
+        }
+
+        numSilentSamples += static_cast<juce::int64> (input.getNumSamples());
+        return sleeping;
+    }
+
+    /*
+     after processing the block shouldSkip() was called with, 'tailLengthInSamples' being
+     at least the latency. true when the instance just fell asleep.
+     */
+    template <typename SampleType>
+    bool update (const juce::dsp::AudioBlock<SampleType>& output, juce::int64 tailLengthInSamples) noexcept
+    {
+        if (sleeping || ! inputSilent || numSilentSamples < tailLengthInSamples || getPeak (output) >= TailLength::SILENCE_FLOOR)
+        {
+            return false;
+        }
+
+        sleeping = true;
+        return true;
+    }
+
+private:
+    // checks a few samples at a time, a non silent block is rejected early
+    static const size_t STEP = 16;
+
+    template <typename SampleType>
+    static bool isSilent (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            const auto* data = block.getChannelPointer (channel);
+            const auto numSamples = block.getNumSamples();
+
+            size_t i = 0;
+            for (; i + STEP <= numSamples; i += STEP)
+            {
+                // NaNs aren't silence either
+                int numNonZero = 0;
+                for (size_t j = 0; j < STEP; ++j)
+                {
+                    numNonZero += data[i + j] != SampleType (0) ? 1 : 0;
+                }
+
+                if (numNonZero != 0)
+                {
+                    return false;
+                }
+            }
+
+            for (; i < numSamples; ++i)
+            {
+                if (data[i] != SampleType (0))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <typename SampleType>
+    static double getPeak (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto range = block.findMinAndMax();
+        return static_cast<double> (juce::jmax (std::abs (range.getStart()), std::abs (range.getEnd())));
+    }
+
+    bool sleeping = false;
+    bool inputSilent = false;
+    juce::int64 numSilentSamples = 0;
+};
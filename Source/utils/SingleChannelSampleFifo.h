@@ -1,7 +1,7 @@
 #pragma once
 
 #include "utils/EqParam.h"
-#include "utils/Fifo.h"
+#include "utils/SpscRing.h"
 
 template <typename BlockType>
 struct SingleChannelSampleFifo
@@ -11,7 +11,9 @@ struct SingleChannelSampleFifo
     {
     }
 
-    void update (const BlockType& buffer)
+    // the buffer may hold another sample type than the fifo, e.g. double while the analyzer works on float
+    template <typename BufferType>
+    void update (const BufferType& buffer)
     {
         if (! isPrepared())
         {
@@ -21,39 +23,40 @@ struct SingleChannelSampleFifo
 
         if (buffer.getNumChannels() > 0)
         {
-            auto* reader = buffer.getReadPointer (static_cast<int> (channelToUse));
-
-            for (int i = 0; i < buffer.getNumSamples(); ++i)
-            {
-                pushNextSampleIntoFifo (reader[i]);
-            }
+            // a mono bus feeds its only channel to both fifos
+            auto* reader = buffer.getReadPointer (juce::jmin (static_cast<int> (channelToUse), buffer.getNumChannels() - 1));
+            pushSamples (reader, static_cast<size_t> (buffer.getNumSamples()));
         }
     }
 
-    void pushNextSampleIntoFifo (SampleType sample)
+    // a chunk of a block, as the FusedBlockPipeline hands them out
+    template <typename BlockSampleType>
+    void update (const juce::dsp::AudioBlock<BlockSampleType>& block)
     {
-        jassert (isPrepared());
-
-        if (fifoIndex == size.get())
+        if (! isPrepared())
         {
-            audioBufferFifo.push (bufferToFill);
-            fifoIndex = 0;
+            jassertfalse;
+            return;
         }
-        auto writePointer = bufferToFill.getWritePointer (0);
-        if (writePointer != nullptr)
+
+        if (block.getNumChannels() > 0)
         {
-            writePointer[fifoIndex] = sample;
-            fifoIndex++;
+            auto* reader = block.getChannelPointer (juce::jmin (static_cast<size_t> (channelToUse), block.getNumChannels() - 1));
+            pushSamples (reader, block.getNumSamples());
         }
     }
 
+    void pushNextSampleIntoFifo (SampleType sample)
+    {
+        jassert (isPrepared());
+        samples.push (sample);
+    }
+
+    // the buffers handed out by getAudioBuffer() hold 'bufferSize' samples
     void prepare (int bufferSize)
     {
         prepared = false;
-        size = juce::jmax (1, bufferSize);
-        bufferToFill.setSize (1, size.get());
-        audioBufferFifo.prepare (size.get(), 1);
-        fifoIndex = 0;
+        size = juce::jlimit (1, static_cast<int> (CAPACITY), bufferSize);
         prepared = true;
     }
 
@@ -63,12 +66,21 @@ struct SingleChannelSampleFifo
         {
             return 0;
         }
-        return audioBufferFifo.getNumAvailableForReading();
+        return samples.getNumAvailableForReading() / size.get();
     }
 
+    // fills 'buf' with the next getSize() samples, if they're all there
     bool getAudioBuffer (BlockType& buf)
     {
-        return audioBufferFifo.pull (buf);
+        auto numSamples = static_cast<size_t> (size.get());
+        if (static_cast<size_t> (samples.getNumAvailableForReading()) < numSamples)
+        {
+            return false;
+        }
+
+        buf.setSize (1, size.get(), false, false, true);
+        samples.pull (buf.getWritePointer (0), numSamples);
+        return true;
     }
 
     bool isPrepared() const
@@ -80,11 +92,33 @@ struct SingleChannelSampleFifo
         return size.get();
     }
 
+    size_t getMemoryFootprint() const
+    {
+        return sizeof (*this);
+    }
+
 private:
+    // the samples go straight into the ring, converted, without an intermediate buffer
+    template <typename SourceType>
+    void pushSamples (const SourceType* reader, size_t numSamples)
+    {
+        // when the ring is full (the editor is closed) the samples that don't fit are dropped
+        auto spans = samples.prepareToWrite (numSamples);
+        std::transform (reader, reader + spans.first.size(), spans.first.begin(), [] (auto sample) { return static_cast<SampleType> (sample); });
+        std::transform (reader + spans.first.size(),
+                        reader + spans.size(),
+                        spans.second.begin(),
+                        [] (auto sample) { return static_cast<SampleType> (sample); });
+        samples.finishedWrite (spans.size());
+    }
+
     Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType, 100> audioBufferFifo;
-    BlockType bufferToFill;
+    /*
+     the PathProducer drains the ring every few ms: 32 buffers of 2048 samples,
+     about 350 ms at 192 kHz.
+     */
+    static const size_t CAPACITY = 1 << 16;
+    SpscRing<SampleType, CAPACITY> samples;
     juce::Atomic<bool> prepared { false };
     juce::Atomic<int> size = 0;
 };
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <span>
+
+/*
+ bounded wait free single producer / single consumer ring of trivially copyable items.
+ - the write and read positions count up forever and are masked into the array:
+   Capacity must be a power of two and the ring holds all Capacity items.
+ - each position lives on its own cache line, next to the copy its owner keeps of the
+   other one: a side only loads the other side's position when its copy says the ring
+   is full (or empty), so most calls touch no shared cache line but the items.
+ - items go in and out one at a time, in runs (push()/pull() with a count), or in
+   place: prepareToWrite()/prepareToRead() hand out the free (or ready) items as at most
+   two spans, finishedWrite()/finishedRead() publish them.
+ the usual names (getNumAvailableForReading()...) are the ones of Fifo, which it replaces
+ for trivially copyable items.
+ */
+template <typename T, size_t Capacity>
+struct SpscRing
+{
+    static_assert (std::is_trivially_copyable_v<T>, "items are copied with plain stores and loads");
+    static_assert (Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    // the free or ready items, in order: 'first' then 'second', which is empty unless the run wraps around
+    template <typename ItemType>
+    struct Spans
+    {
+        std::span<ItemType> first, second;
+
+        size_t size() const noexcept
+        {
+            return first.size() + second.size();
+        }
+    };
+
+    size_t getSize() const noexcept
+    {
+        return Capacity;
+    }
+
+    //==============================================================================
+    // producer
+
+    bool push (const T& item) noexcept
+    {
+        auto spans = prepareToWrite (1);
+        if (spans.size() == 0)
+        {
+            return false;
+        }
+
+        spans.first[0] = item;
+        finishedWrite (1);
+        return true;
+    }
+
+    // pushes as many of the 'count' items as fit, returns how many
+    size_t push (const T* items, size_t count) noexcept
+    {
+        auto spans = prepareToWrite (count);
+        std::copy_n (items, spans.first.size(), spans.first.begin());
+        std::copy_n (items + spans.first.size(), spans.second.size(), spans.second.begin());
+        finishedWrite (spans.size());
+        return spans.size();
+    }
+
+    // at most 'maxCount' free items, to be filled and published with finishedWrite()
+    Spans<T> prepareToWrite (size_t maxCount) noexcept
+    {
+        auto write = producer.position.load (std::memory_order_relaxed);
+        if (Capacity - (write - producer.otherPosition) < maxCount)
+        {
+            producer.otherPosition = consumer.position.load (std::memory_order_acquire);
+        }
+
+        auto count = juce::jmin (maxCount, Capacity - (write - producer.otherPosition));
+        return getSpans<T> (items.data(), write, count);
+    }
+
+    // publishes the first 'count' items of the last prepareToWrite()
+    void finishedWrite (size_t count) noexcept
+    {
+        producer.position.store (producer.position.load (std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    int getAvailableSpace() const noexcept
+    {
+        return static_cast<int> (Capacity - getNumReady());
+    }
+
+    //==============================================================================
+    // consumer
+
+    bool pull (T& item) noexcept
+    {
+        auto spans = prepareToRead (1);
+        if (spans.size() == 0)
+        {
+            return false;
+        }
+
+        item = spans.first[0];
+        finishedRead (1);
+        return true;
+    }
+
+    // pulls at most 'count' items, returns how many
+    size_t pull (T* destination, size_t count) noexcept
+    {
+        auto spans = prepareToRead (count);
+        std::copy (spans.first.begin(), spans.first.end(), destination);
+        std::copy (spans.second.begin(), spans.second.end(), destination + spans.first.size());
+        finishedRead (spans.size());
+        return spans.size();
+    }
+
+    // at most 'maxCount' ready items, to be released with finishedRead()
+    Spans<const T> prepareToRead (size_t maxCount) noexcept
+    {
+        auto read = consumer.position.load (std::memory_order_relaxed);
+        if (consumer.otherPosition - read < maxCount)
+        {
+            consumer.otherPosition = producer.position.load (std::memory_order_acquire);
+        }
+
+        auto count = juce::jmin (maxCount, static_cast<size_t> (consumer.otherPosition - read));
+        return getSpans<const T> (items.data(), read, count);
+    }
+
+    // releases the first 'count' items of the last prepareToRead()
+    void finishedRead (size_t count) noexcept
+    {
+        consumer.position.store (consumer.position.load (std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // exact on the consumer thread, a lower bound on the producer thread
+    int getNumAvailableForReading() const noexcept
+    {
+        return static_cast<int> (getNumReady());
+    }
+
+    size_t getMemoryFootprint() const noexcept
+    {
+        return sizeof (*this);
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    template <typename ItemType, typename Pointer>
+    static Spans<ItemType> getSpans (Pointer data, size_t position, size_t count) noexcept
+    {
+        auto start = position & MASK;
+        auto firstSize = juce::jmin (count, Capacity - start);
+        return { { data + start, firstSize }, { data, count - firstSize } };
+    }
+
+    size_t getNumReady() const noexcept
+    {
+        auto read = consumer.position.load (std::memory_order_acquire);
+        auto write = producer.position.load (std::memory_order_acquire);
+        return static_cast<size_t> (write - read);
+    }
+
+    // a position and what its owner last saw of the other side's one
+    struct alignas (CACHE_LINE_SIZE) Side
+    {
+        std::atomic<size_t> position { 0 };
+        size_t otherPosition = 0;
+    };
+
+    Side producer, consumer;
+    alignas (CACHE_LINE_SIZE) std::array<T, Capacity> items {};
+};
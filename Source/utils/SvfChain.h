@@ -0,0 +1,188 @@
+#pragma once
+
+#include "data/FilterParameters.h"
+#include "utils/EqCutFilterDesign.h"
+#include "utils/SvfFilter.h"
+#include <JuceHeader.h>
+
+/*
+ one band of the SVF engine: a single section for the parametric bands,
+ up to 4 sections for the cut filters (same butterworth layout as EqCutFilterDesign).
+ new parameters only compute the target coefficients, the sections ramp
+ towards them per sample.
+ peak and shelf bands at 0 dB are skipped once their ramp is over.
+ */
+template <typename FloatType>
+struct SvfBand
+{
+    static const size_t MAX_SECTIONS = EqCutFilterDesign::MAX_BIQUAD_FILTERS;
+
+    void reset()
+    {
+        for (auto& section : sections)
+        {
+            section.reset();
+        }
+    }
+
+    void setParameters (const FilterParameters& params, int rampLengthInSamples)
+    {
+        if (hasParameters && params == parametricParams)
+        {
+            return;
+        }
+
+        auto ramp = updateBypass (params.bypassed, rampLengthInSamples);
+        parametricParams = params;
+        hasParameters = true;
+
+        auto isIdentityType = params.type == FilterInfo::FilterType::PEAKFILTER || params.type == FilterInfo::FilterType::LOWSHELF
+                              || params.type == FilterInfo::FilterType::HIGHSHELF;
+        isIdentity = isIdentityType && params.gain == Decibel<float> (0.0f);
+
+        numSections = 1;
+        sections[0].setTarget (SvfCoefficientsMaker<FloatType>::make (params.type,
+                                                                      params.frequency,
+                                                                      params.quality,
+                                                                      params.gain.getGain(),
+                                                                      params.sampleRate),
+                               ramp);
+    }
+
+    void setParameters (const HighCutLowCutParameters& params, int rampLengthInSamples)
+    {
+        if (hasParameters && params == cutParams)
+        {
+            return;
+        }
+
+        auto ramp = updateBypass (params.bypassed, rampLengthInSamples);
+        if (hasParameters && params.order != cutParams.order)
+        {
+            ramp = 0;
+        }
+        cutParams = params;
+        hasParameters = true;
+        isIdentity = false;
+
+        auto layout = EqCutFilterDesign::getButterworthLayout (params.order + 1, params.quality);
+        auto firstOrderType = params.isLowCut ? FilterInfo::FilterType::FIRST_ORDER_HIGHPASS : FilterInfo::FilterType::FIRST_ORDER_LOWPASS;
+        auto secondOrderType = params.isLowCut ? FilterInfo::FilterType::HIGHPASS : FilterInfo::FilterType::LOWPASS;
+
+        numSections = 0;
+        if (layout.hasFirstOrderSection)
+        {
+            sections[numSections++].setTarget (SvfCoefficientsMaker<FloatType>::make (firstOrderType,
+                                                                                      params.frequency,
+                                                                                      1.0f,
+                                                                                      1.0f,
+                                                                                      params.sampleRate),
+                                               ramp);
+        }
+
+        for (size_t i = 0; i < static_cast<size_t> (layout.numBiquadFilters); ++i)
+        {
+            sections[numSections++].setTarget (SvfCoefficientsMaker<FloatType>::make (secondOrderType,
+                                                                                      params.frequency,
+                                                                                      static_cast<float> (layout.qualities[i]),
+                                                                                      1.0f,
+                                                                                      params.sampleRate),
+                                               ramp);
+        }
+    }
+
+    void process (FloatType* data, int numSamples) noexcept
+    {
+        if (bypassed || (isIdentity && ! isSmoothing()))
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < numSections; ++i)
+        {
+            sections[i].process (data, numSamples);
+        }
+    }
+
+    bool isSmoothing() const
+    {
+        return std::any_of (sections.begin(), sections.begin() + numSections, [] (const auto& s) { return s.isSmoothing(); });
+    }
+
+private:
+    /*
+     a band coming out of bypass starts from silence and jumps straight
+     to its target: ramping from stale coefficients would be meaningless.
+     */
+    int updateBypass (bool shouldBeBypassed, int rampLengthInSamples)
+    {
+        auto wasBypassed = bypassed;
+        bypassed = shouldBeBypassed;
+
+        if (! hasParameters || (wasBypassed && ! bypassed))
+        {
+            reset();
+            return 0;
+        }
+
+        return rampLengthInSamples;
+    }
+
+    std::array<SvfSection<FloatType>, MAX_SECTIONS> sections;
+    size_t numSections = 0;
+    bool bypassed = true;
+    bool isIdentity = false;
+    bool hasParameters = false;
+
+    FilterParameters parametricParams;
+    HighCutLowCutParameters cutParams;
+};
+
+/*
+ SVF counterpart of ChainHelpers::MonoChain: 8 bands in chain order, processed
+ over the whole block with per sample coefficient smoothing, so it needs no
+ sub-block splitting and no coefficient generator thread.
+ */
+template <typename FloatType>
+struct SvfChain
+{
+    static const size_t NUM_BANDS = 8;
+
+    void prepare (double sampleRate, float rampTimeInSeconds)
+    {
+        rampLengthInSamples = juce::roundToInt (sampleRate * rampTimeInSeconds);
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& band : bands)
+        {
+            band.reset();
+        }
+    }
+
+    template <typename ParamType>
+    void setParameters (size_t bandIndex, const ParamType& params)
+    {
+        jassert (bandIndex < NUM_BANDS);
+        bands[bandIndex].setParameters (params, rampLengthInSamples);
+    }
+
+    void process (FloatType* data, int numSamples) noexcept
+    {
+        for (auto& band : bands)
+        {
+            band.process (data, numSamples);
+        }
+    }
+
+    bool isSmoothing() const
+    {
+        return std::any_of (bands.begin(), bands.end(), [] (const auto& band) { return band.isSmoothing(); });
+    }
+
+private:
+    std::array<SvfBand<FloatType>, NUM_BANDS> bands;
+    int rampLengthInSamples = 0;
+};
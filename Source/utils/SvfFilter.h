@@ -0,0 +1,268 @@
+#pragma once
+
+#include "utils/FilterType.h"
+#include <JuceHeader.h>
+
+/*
+ trapezoidal (zero delay feedback) state variable filter, as described by
+ Andrew Simper in "Linear Trap Integrated SVF".
+ the filter stays stable for any positive g and k, so its coefficients can
+ be interpolated sample by sample without the zipper noise or blow ups that
+ a direct form biquad exhibits under fast modulation.
+
+ the output is a mix of the input (v0), the bandpass (v1) and the lowpass (v2)
+ outputs: y = m0 * v0 + m1 * v1 + m2 * v2.
+ first order types use a one pole TPT integrator instead, and the output is
+ y = m0 * v0 + m1 * lowpass.
+ */
+template <typename FloatType>
+struct SvfCoefficients
+{
+    FloatType g = FloatType (0);
+    FloatType k = FloatType (1);
+    FloatType m0 = FloatType (1);
+    FloatType m1 = FloatType (0);
+    FloatType m2 = FloatType (0);
+    bool isFirstOrder = false;
+};
+
+template <typename FloatType>
+struct SvfCoefficientsMaker
+{
+    SvfCoefficientsMaker() = delete;
+    ~SvfCoefficientsMaker() = delete;
+
+    /*
+     'gain' is a linear gain factor, the same that CoefficientsMaker expects.
+     one tan and one sqrt, so this is cheap enough to run on the audio thread.
+     */
+    static SvfCoefficients<FloatType> make (FilterInfo::FilterType type, //
+                                            float freq,
+                                            float q,
+                                            float gain,
+                                            double sampleRate)
+    {
+        jassert (sampleRate > 0 && q > 0);
+
+        auto nyquistLimitedFrequency = juce::jmin (static_cast<double> (freq), sampleRate * 0.49);
+        auto g = static_cast<FloatType> (std::tan (juce::MathConstants<double>::pi * nyquistLimitedFrequency / sampleRate));
+        auto k = static_cast<FloatType> (1.0 / q);
+        auto A = static_cast<FloatType> (std::sqrt (juce::jmax (gain, 0.0f)));
+
+        SvfCoefficients<FloatType> c;
+        c.g = g;
+        c.k = k;
+
+        switch (type)
+        {
+            case FilterInfo::FilterType::FIRST_ORDER_LOWPASS:
+                return makeFirstOrder (g, 0, 1);
+            case FilterInfo::FilterType::FIRST_ORDER_HIGHPASS:
+                return makeFirstOrder (g, 1, -1);
+            case FilterInfo::FilterType::FIRST_ORDER_ALLPASS:
+                return makeFirstOrder (g, -1, 2);
+            case FilterInfo::FilterType::LOWPASS:
+                return withMix (c, 0, 0, 1);
+            case FilterInfo::FilterType::HIGHPASS:
+                return withMix (c, 1, -k, -1);
+            case FilterInfo::FilterType::BANDPASS:
+                return withMix (c, 0, k, 0);
+            case FilterInfo::FilterType::NOTCH:
+                return withMix (c, 1, -k, 0);
+            case FilterInfo::FilterType::ALLPASS:
+                return withMix (c, 1, -2 * k, 0);
+            case FilterInfo::FilterType::LOWSHELF:
+                c.g = g / std::sqrt (A);
+                return withMix (c, 1, k * (A - 1), A * A - 1);
+            case FilterInfo::FilterType::HIGHSHELF:
+                c.g = g * std::sqrt (A);
+                return withMix (c, A * A, k * (1 - A) * A, 1 - A * A);
+            case FilterInfo::FilterType::PEAKFILTER:
+                c.k = k / A;
+                return withMix (c, 1, c.k * (A * A - 1), 0);
+            default:
+                jassertfalse;
+                return {};
+        }
+    }
+
+private:
+    static SvfCoefficients<FloatType> makeFirstOrder (FloatType g, FloatType m0, FloatType m1)
+    {
+        SvfCoefficients<FloatType> c;
+        c.g = g;
+        c.isFirstOrder = true;
+        return withMix (c, m0, m1, 0);
+    }
+
+    static SvfCoefficients<FloatType> withMix (SvfCoefficients<FloatType> c, FloatType m0, FloatType m1, FloatType m2)
+    {
+        c.m0 = m0;
+        c.m1 = m1;
+        c.m2 = m2;
+        return c;
+    }
+};
+
+/*
+ a single SVF section whose coefficients ramp linearly towards their target,
+ one step per sample.
+ */
+template <typename FloatType>
+struct SvfSection
+{
+    void reset()
+    {
+        ic1eq = FloatType (0);
+        ic2eq = FloatType (0);
+    }
+
+    void setTarget (const SvfCoefficients<FloatType>& newTarget, int rampLengthInSamples)
+    {
+        if (newTarget.isFirstOrder != current.isFirstOrder)
+        {
+            // the topology changed: there is nothing meaningful to ramp from
+            rampLengthInSamples = 0;
+            reset();
+        }
+
+        target = newTarget;
+
+        if (rampLengthInSamples <= 0)
+        {
+            current = target;
+            samplesToTarget = 0;
+            return;
+        }
+
+        auto scale = FloatType (1) / static_cast<FloatType> (rampLengthInSamples);
+        step.g = (target.g - current.g) * scale;
+        step.k = (target.k - current.k) * scale;
+        step.m0 = (target.m0 - current.m0) * scale;
+        step.m1 = (target.m1 - current.m1) * scale;
+        step.m2 = (target.m2 - current.m2) * scale;
+        samplesToTarget = rampLengthInSamples;
+    }
+
+    bool isSmoothing() const
+    {
+        return samplesToTarget > 0;
+    }
+
+    void process (FloatType* data, int numSamples) noexcept
+    {
+        int i = 0;
+
+        while (i < numSamples && samplesToTarget > 0)
+        {
+            advance();
+            data[i] = processSample (data[i]);
+            ++i;
+        }
+
+        if (i < numSamples)
+        {
+            if (current.isFirstOrder)
+            {
+                processFirstOrder (data + i, numSamples - i);
+            }
+            else
+            {
+                processSecondOrder (data + i, numSamples - i);
+            }
+        }
+
+        juce::dsp::util::snapToZero (ic1eq);
+        juce::dsp::util::snapToZero (ic2eq);
+    }
+
+private:
+    void advance() noexcept
+    {
+        if (--samplesToTarget == 0)
+        {
+            current = target;
+            return;
+        }
+
+        current.g += step.g;
+        current.k += step.k;
+        current.m0 += step.m0;
+        current.m1 += step.m1;
+        current.m2 += step.m2;
+    }
+
+    FloatType processSample (FloatType v0) noexcept
+    {
+        if (current.isFirstOrder)
+        {
+            auto G = current.g / (FloatType (1) + current.g);
+            auto v = (v0 - ic1eq) * G;
+            auto lowpass = v + ic1eq;
+            ic1eq = lowpass + v;
+            return current.m0 * v0 + current.m1 * lowpass;
+        }
+
+        auto a1 = FloatType (1) / (FloatType (1) + current.g * (current.g + current.k));
+        auto a2 = current.g * a1;
+        auto a3 = current.g * a2;
+
+        auto v3 = v0 - ic2eq;
+        auto v1 = a1 * ic1eq + a2 * v3;
+        auto v2 = ic2eq + a2 * ic1eq + a3 * v3;
+        ic1eq = FloatType (2) * v1 - ic1eq;
+        ic2eq = FloatType (2) * v2 - ic2eq;
+
+        return current.m0 * v0 + current.m1 * v1 + current.m2 * v2;
+    }
+
+    void processFirstOrder (FloatType* data, int numSamples) noexcept
+    {
+        const auto G = current.g / (FloatType (1) + current.g);
+        const auto m0 = current.m0;
+        const auto m1 = current.m1;
+        auto s = ic1eq;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto v0 = data[i];
+            auto v = (v0 - s) * G;
+            auto lowpass = v + s;
+            s = lowpass + v;
+            data[i] = m0 * v0 + m1 * lowpass;
+        }
+
+        ic1eq = s;
+    }
+
+    void processSecondOrder (FloatType* data, int numSamples) noexcept
+    {
+        const auto a1 = FloatType (1) / (FloatType (1) + current.g * (current.g + current.k));
+        const auto a2 = current.g * a1;
+        const auto a3 = current.g * a2;
+        const auto m0 = current.m0;
+        const auto m1 = current.m1;
+        const auto m2 = current.m2;
+        auto s1 = ic1eq;
+        auto s2 = ic2eq;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto v0 = data[i];
+            auto v3 = v0 - s2;
+            auto v1 = a1 * s1 + a2 * v3;
+            auto v2 = s2 + a2 * s1 + a3 * v3;
+            s1 = FloatType (2) * v1 - s1;
+            s2 = FloatType (2) * v2 - s2;
+            data[i] = m0 * v0 + m1 * v1 + m2 * v2;
+        }
+
+        ic1eq = s1;
+        ic2eq = s2;
+    }
+
+    SvfCoefficients<FloatType> current, target, step;
+    int samplesToTarget = 0;
+    FloatType ic1eq = FloatType (0);
+    FloatType ic2eq = FloatType (0);
+};
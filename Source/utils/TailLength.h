@@ -0,0 +1,70 @@
+#pragma once
+
+#include "utils/BiquadSection.h"
+#include "utils/LinearPhaseFirDesign.h"
+#include <JuceHeader.h>
+
+/*
+ how long a chain keeps ringing once its input stops: the time its slowest poles need
+ to decay below SILENCE_FLOOR.
+ a section decays like r^n, r being the radius of its largest pole, the tails of the
+ sections of a cascade are added up: that's an upper bound of the tail of the cascade.
+ */
+namespace TailLength
+{
+// the least significant bit of 24 bit audio
+static const double SILENCE_FLOOR = 1.0 / (1 << 24);
+
+// poles on or outside the unit circle don't decay, the tail is capped instead
+static const double MAX_TAIL_LENGTH_IN_SECONDS = 10.0;
+
+inline double getPoleRadius (const BiquadSection<double>& section)
+{
+    // z^2 + a1 z + a2, or z + a1 for a first order section
+    if (section.a2 == 0.0)
+    {
+        return std::abs (section.a1);
+    }
+
+    auto discriminant = section.a1 * section.a1 - 4.0 * section.a2;
+    if (discriminant < 0.0)
+    {
+        // complex conjugate poles, their product is a2
+        return std::sqrt (section.a2);
+    }
+
+    auto root = std::sqrt (discriminant);
+    return juce::jmax (std::abs (-section.a1 + root), std::abs (-section.a1 - root)) * 0.5;
+}
+
+inline double getTailLengthInSamples (const BiquadSection<double>& section, double maxLengthInSamples)
+{
+    auto radius = getPoleRadius (section);
+    if (radius <= 0.0)
+    {
+        // FIR sections settle after their 2 samples of state
+        return 2.0;
+    }
+
+    if (radius >= 1.0)
+    {
+        return maxLengthInSamples;
+    }
+
+    return juce::jmin (maxLengthInSamples, std::log (SILENCE_FLOOR) / std::log (radius));
+}
+
+// 'batch' holds the sections of the chain, see LinearPhaseFirDesign::computeSections()
+inline double getTailLengthInSeconds (const LinearPhaseFirDesign::ChainBatch& batch, double sampleRate)
+{
+    const auto maxLengthInSamples = MAX_TAIL_LENGTH_IN_SECONDS * sampleRate;
+
+    double lengthInSamples = 0.0;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        lengthInSamples += getTailLengthInSamples (batch.getSection (i), maxLengthInSamples);
+    }
+
+    return juce::jmin (lengthInSamples, maxLengthInSamples) / sampleRate;
+}
+} // namespace TailLength
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "utils/ChainHelpers.h"
+#include <JuceHeader.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace Benchmark
+{
+static const double SAMPLE_RATE = 48000.0;
+// the samples of a run and the runs of a result, see run()
+static const int NUM_SAMPLES = 32768;
+static const int NUM_RUNS = 21;
+
+struct Result
+{
+    juce::String name;
+    double nsPerSample = 0.0;
+    // difference between the slowest and the fastest run, in ns/sample
+    double spread = 0.0;
+    // what was measured, for the JSON report: mode, block size...
+    juce::NamedValueSet configuration;
+};
+
+/*
+ calls 'process' once to warm up and then 'numRuns' more times, each call
+ being expected to process 'numSamplesPerRun' samples.
+ the reported figure is the median of the runs.
+ */
+template <typename ProcessFunction>
+Result run (const juce::String& name, int numRuns, int numSamplesPerRun, ProcessFunction&& process)
+{
+    jassert (numRuns > 0 && numSamplesPerRun > 0);
+
+    process();
+
+    std::vector<double> nsPerSample;
+    nsPerSample.reserve (static_cast<size_t> (numRuns));
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        process();
+        auto end = juce::Time::getHighResolutionTicks();
+
+        auto seconds = juce::Time::highResolutionTicksToSeconds (end - start);
+        nsPerSample.push_back (seconds * 1.0e9 / numSamplesPerRun);
+    }
+
+    std::sort (nsPerSample.begin(), nsPerSample.end());
+
+    Result result;
+    result.name = name;
+    result.nsPerSample = nsPerSample[nsPerSample.size() / 2];
+    result.spread = nsPerSample.back() - nsPerSample.front();
+    return result;
+}
+
+inline void fillWithNoise (juce::AudioBuffer<float>& buffer, juce::Random& random)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* writer = buffer.getWritePointer (channel);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            writer[i] = random.nextFloat() * 2.0f - 1.0f;
+        }
+    }
+}
+
+inline HighCutLowCutParameters makeCutParameters (float frequency, bool isLowCut, int slope)
+{
+    HighCutLowCutParameters params;
+    params.frequency = frequency;
+    params.quality = 0.707f;
+    params.sampleRate = SAMPLE_RATE;
+    params.order = slope;
+    params.isLowCut = isLowCut;
+    return params;
+}
+
+inline FilterParameters makeParametricParameters (float frequency, FilterInfo::FilterType type, float gainDb)
+{
+    FilterParameters params;
+    params.frequency = frequency;
+    params.quality = 1.0f;
+    params.sampleRate = SAMPLE_RATE;
+    params.type = type;
+    params.gain = Decibel<float> (gainDb);
+    return params;
+}
+
+// the four peak bands of 'chain', alternately boosting and cutting by 'gainDb'
+inline void configurePeaks (ChainHelpers::MonoChain& chain, float gainDb)
+{
+    using FilterInfo::FilterType;
+    chain.get<2>().initialize (makeParametricParameters (200.0f, FilterType::PEAKFILTER, gainDb), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+    chain.get<3>().initialize (makeParametricParameters (800.0f, FilterType::PEAKFILTER, -gainDb), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+    chain.get<4>().initialize (makeParametricParameters (2500.0f, FilterType::PEAKFILTER, gainDb), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+    chain.get<5>().initialize (makeParametricParameters (6000.0f, FilterType::PEAKFILTER, -gainDb), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+}
+
+// all 8 bands of 'chain': the peaks, the shelves and the cuts, with 'slope' (0 is 6 dB/oct)
+inline void configureChain (ChainHelpers::MonoChain& chain, int slope, float gainDb)
+{
+    configurePeaks (chain, gainDb);
+
+    using FilterInfo::FilterType;
+    chain.get<0>().initialize (makeCutParameters (30.0f, true, slope), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+    chain.get<1>().initialize (makeParametricParameters (80.0f, FilterType::LOWSHELF, gainDb), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+    chain.get<6>().initialize (makeParametricParameters (10000.0f, FilterType::HIGHSHELF, gainDb), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+    chain.get<7>().initialize (makeCutParameters (18000.0f, false, slope), RAMP_TIME_IN_SECONDS, false, SAMPLE_RATE);
+}
+
+// 'buffer' in consecutive blocks of at most 'blockSize' samples, as a host or the processor splits it
+template <typename SampleType, typename ProcessBlock>
+void processInBlocks (juce::AudioBuffer<SampleType>& buffer, int blockSize, ProcessBlock&& processBlock)
+{
+    auto block = juce::dsp::AudioBlock<SampleType> (buffer);
+    for (size_t offset = 0; offset < block.getNumSamples(); offset += static_cast<size_t> (blockSize))
+    {
+        processBlock (block.getSubBlock (offset, juce::jmin (block.getNumSamples() - offset, static_cast<size_t> (blockSize))));
+    }
+}
+
+inline void print (const std::vector<Result>& results)
+{
+    for (const auto& result : results)
+    {
+        std::cout << result.name << ": " << juce::String (result.nsPerSample, 3) << " ns/sample (spread "
+                  << juce::String (result.spread, 3) << ")" << std::endl;
+    }
+}
+/*
+ the results as JSON, for tracking them from one release to the next:
+ { "cpu": ..., "results": [ { "name": ..., "nsPerSample": ..., "spread": ..., "configuration": { ... } } ] }
+ */
+inline juce::String toJson (const std::vector<Result>& results)
+{
+    juce::Array<juce::var> entries;
+    for (const auto& result : results)
+    {
+        auto configuration = std::make_unique<juce::DynamicObject>();
+        for (const auto& property : result.configuration)
+        {
+            configuration->setProperty (property.name, property.value);
+        }
+
+        auto entry = std::make_unique<juce::DynamicObject>();
+        entry->setProperty ("name", result.name);
+        entry->setProperty ("nsPerSample", result.nsPerSample);
+        entry->setProperty ("spread", result.spread);
+        entry->setProperty ("configuration", juce::var (configuration.release()));
+        entries.add (juce::var (entry.release()));
+    }
+
+    auto report = std::make_unique<juce::DynamicObject>();
+    report->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty ("numCpus", juce::SystemStats::getNumCpus());
+    report->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+    report->setProperty ("results", entries);
+    return juce::JSON::toString (juce::var (report.release()));
+}
+} // namespace Benchmark
@@ -0,0 +1,118 @@
+#include "Benchmark.h"
+#include "utils/BatchCoefficientsMaker.h"
+#include "utils/CoefficientsMaker.h"
+#include <JuceHeader.h>
+
+namespace
+{
+// the figures are per audio sample when coefficients are updated every CONTROL_RATE samples
+const int CONTROL_RATE = 32;
+const int NUM_UPDATES = 1024;
+const size_t NUM_LANES = 2;
+
+struct BandSet
+{
+    std::array<HighCutLowCutParameters, 2> cuts;
+    std::array<FilterParameters, 6> parametrics;
+};
+
+BandSet makeBands (int update)
+{
+    // sweep every band a little on every update, like an automation ramp would
+    auto sweep = 1.0f + 0.5f * static_cast<float> (update % 64) / 64.0f;
+
+    BandSet bands;
+    for (size_t i = 0; i < bands.cuts.size(); ++i)
+    {
+        auto& params = bands.cuts[i];
+        params.isLowCut = i == 0;
+        params.frequency = (params.isLowCut ? 30.0f : 12000.0f) * sweep;
+        params.quality = 0.707f;
+        params.order = 6;
+        params.sampleRate = Benchmark::SAMPLE_RATE;
+    }
+
+    const std::array<FilterInfo::FilterType, 6> types { FilterInfo::FilterType::LOWSHELF,   FilterInfo::FilterType::PEAKFILTER,
+                                                        FilterInfo::FilterType::PEAKFILTER, FilterInfo::FilterType::PEAKFILTER,
+                                                        FilterInfo::FilterType::PEAKFILTER, FilterInfo::FilterType::HIGHSHELF };
+    for (size_t i = 0; i < bands.parametrics.size(); ++i)
+    {
+        auto& params = bands.parametrics[i];
+        params.type = types[i];
+        params.frequency = 80.0f * std::pow (2.5f, static_cast<float> (i)) * sweep;
+        params.quality = 1.0f;
+        params.gain = Decibel<float> (6.0f * sweep);
+        params.sampleRate = Benchmark::SAMPLE_RATE;
+    }
+
+    return bands;
+}
+} // namespace
+
+std::vector<Benchmark::Result> runCoefficientsBenchmarks()
+{
+    std::vector<BandSet> updates;
+    for (int update = 0; update < NUM_UPDATES; ++update)
+    {
+        updates.push_back (makeBands (update));
+    }
+
+    std::vector<Benchmark::Result> results;
+    float sink = 0.0f;
+
+    results.push_back (Benchmark::run ("CoefficientsMaker, 2 x 8 bands",
+                                       Benchmark::NUM_RUNS,
+                                       NUM_UPDATES * CONTROL_RATE,
+                                       [&]
+                                       {
+                                           for (const auto& bands : updates)
+                                           {
+                                               for (size_t lane = 0; lane < NUM_LANES; ++lane)
+                                               {
+                                                   for (const auto& params : bands.cuts)
+                                                   {
+                                                       auto coefficients = CoefficientsMaker<float>::make (params);
+                                                       sink += coefficients[0]->coefficients[0];
+                                                   }
+                                                   for (const auto& params : bands.parametrics)
+                                                   {
+                                                       auto coefficients = CoefficientsMaker<float>::make (params);
+                                                       sink += coefficients->coefficients[0];
+                                                   }
+                                               }
+                                           }
+                                       }));
+
+    CoefficientsBatch<32> batch;
+    results.push_back (Benchmark::run ("CoefficientsBatch, 2 x 8 bands",
+                                       Benchmark::NUM_RUNS,
+                                       NUM_UPDATES * CONTROL_RATE,
+                                       [&]
+                                       {
+                                           for (const auto& bands : updates)
+                                           {
+                                               batch.clear();
+                                               for (size_t lane = 0; lane < NUM_LANES; ++lane)
+                                               {
+                                                   for (const auto& params : bands.cuts)
+                                                   {
+                                                       batch.addSections (params);
+                                                   }
+                                                   for (const auto& params : bands.parametrics)
+                                                   {
+                                                       batch.addSections (params);
+                                                   }
+                                               }
+                                               batch.compute();
+                                               sink += batch.getSection (0).b0;
+                                           }
+                                       }));
+
+    // keeps the optimiser from removing the loops
+    if (sink == 0.0f)
+    {
+        std::cout << "";
+    }
+
+    return results;
+}
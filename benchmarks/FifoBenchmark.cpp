@@ -0,0 +1,181 @@
+#include "Benchmark.h"
+#include "data/MeterValues.h"
+#include "utils/Fifo.h"
+#include "utils/SpscRing.h"
+#include <JuceHeader.h>
+#include <thread>
+
+namespace
+{
+const int NUM_ITEMS = 1 << 20;
+// fewer than Benchmark::NUM_RUNS, every run moves a million items
+const int NUM_RUNS = 11;
+const int CAPACITY = 1024;
+
+// the analyzer's chunks, and a host block of samples
+const int CHUNK_SIZE = 2048;
+const int BLOCK_SIZE = 512;
+
+/*
+ 'numItems' items, one at a time: with 'crossThread', a producer thread pushes while the
+ calling thread pulls, otherwise the calling thread fills the queue and empties it in turn.
+ the figures are per item.
+ */
+template <typename Queue>
+void transferItems (Queue& queue, int numItems, bool crossThread)
+{
+    MeterValues item;
+    if (crossThread)
+    {
+        std::thread producer (
+            [&queue, numItems]
+            {
+                MeterValues value;
+                for (int i = 0; i < numItems;)
+                {
+                    value.leftPeakDb = Decibel<float> (static_cast<float> (i));
+                    if (queue.push (value))
+                    {
+                        ++i;
+                    }
+                }
+            });
+
+        for (int i = 0; i < numItems;)
+        {
+            if (queue.pull (item))
+            {
+                ++i;
+            }
+        }
+        producer.join();
+        return;
+    }
+
+    for (int i = 0; i < numItems; i += CAPACITY / 2)
+    {
+        for (int j = 0; j < CAPACITY / 2; ++j)
+        {
+            queue.push (item);
+        }
+        for (int j = 0; j < CAPACITY / 2; ++j)
+        {
+            queue.pull (item);
+        }
+    }
+}
+
+// what the analyzer fifo did before: a buffer filled sample by sample and copied in and out of the fifo
+struct BufferFifo
+{
+    BufferFifo()
+    {
+        fifo.prepare (CHUNK_SIZE, 1);
+        bufferToFill.setSize (1, CHUNK_SIZE);
+    }
+
+    void push (const float* samples, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (fifoIndex == CHUNK_SIZE)
+            {
+                fifo.push (bufferToFill);
+                fifoIndex = 0;
+            }
+            bufferToFill.setSample (0, fifoIndex++, samples[i]);
+        }
+    }
+
+    bool pull (juce::AudioBuffer<float>& chunk)
+    {
+        return fifo.pull (chunk);
+    }
+
+    Fifo<juce::AudioBuffer<float>, 32> fifo;
+    juce::AudioBuffer<float> bufferToFill;
+    int fifoIndex = 0;
+};
+
+// the analyzer fifo now: the block goes straight into the ring, chunks come out of it
+struct RingFifo
+{
+    void push (const float* samples, int numSamples)
+    {
+        ring.push (samples, static_cast<size_t> (numSamples));
+    }
+
+    bool pull (juce::AudioBuffer<float>& chunk)
+    {
+        if (ring.getNumAvailableForReading() < CHUNK_SIZE)
+        {
+            return false;
+        }
+        ring.pull (chunk.getWritePointer (0), CHUNK_SIZE);
+        return true;
+    }
+
+    SpscRing<float, 32 * CHUNK_SIZE> ring;
+};
+
+// 'numSamples' samples pushed in host blocks, pulled in chunks, on the calling thread, the figures are per sample
+template <typename SampleFifo>
+void transferSamples (SampleFifo& fifo, const juce::AudioBuffer<float>& block, juce::AudioBuffer<float>& chunk, int numSamples)
+{
+    for (int i = 0; i < numSamples; i += BLOCK_SIZE)
+    {
+        fifo.push (block.getReadPointer (0), BLOCK_SIZE);
+        while (fifo.pull (chunk))
+        {
+        }
+    }
+}
+
+juce::String getName (const juce::String& queue, bool crossThread)
+{
+    return queue + (crossThread ? ", producer thread" : ", single thread");
+}
+} // namespace
+
+/*
+ the Fifo (juce::AbstractFifo) against the SpscRing that replaced it:
+ MeterValues one at a time, as the meters send them, and the samples of the analyzer.
+ */
+std::vector<Benchmark::Result> runFifoBenchmarks()
+{
+    std::vector<Benchmark::Result> results;
+
+    for (auto crossThread : { false, true })
+    {
+        auto fifo = std::make_unique<Fifo<MeterValues, CAPACITY>>();
+        results.push_back (Benchmark::run (getName ("Fifo MeterValues", crossThread),
+                                           NUM_RUNS,
+                                           NUM_ITEMS,
+                                           [&] { transferItems (*fifo, NUM_ITEMS, crossThread); }));
+
+        auto ring = std::make_unique<SpscRing<MeterValues, CAPACITY>>();
+        results.push_back (Benchmark::run (getName ("SpscRing MeterValues", crossThread),
+                                           NUM_RUNS,
+                                           NUM_ITEMS,
+                                           [&] { transferItems (*ring, NUM_ITEMS, crossThread); }));
+    }
+
+    juce::Random random { 42 };
+    juce::AudioBuffer<float> block { 1, BLOCK_SIZE };
+    Benchmark::fillWithNoise (block, random);
+    juce::AudioBuffer<float> chunk { 1, CHUNK_SIZE };
+
+    auto bufferFifo = std::make_unique<BufferFifo>();
+    results.push_back (Benchmark::run ("analyzer samples, Fifo of buffers",
+                                       NUM_RUNS,
+                                       NUM_ITEMS,
+                                       [&] { transferSamples (*bufferFifo, block, chunk, NUM_ITEMS); }));
+
+    auto ringFifo = std::make_unique<RingFifo>();
+    results.push_back (Benchmark::run ("analyzer samples, SpscRing",
+                                       NUM_RUNS,
+                                       NUM_ITEMS,
+                                       [&] { transferSamples (*ringFifo, block, chunk, NUM_ITEMS); }));
+
+    return results;
+}
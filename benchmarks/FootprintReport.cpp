@@ -0,0 +1,38 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+#include "utils/PathProducer.h"
+#include <JuceHeader.h>
+
+namespace
+{
+const int BLOCK_SIZE = 512;
+} // namespace
+
+/*
+ the memory a stereo instance holds once prepared, per subsystem, and the analyzer its
+ editor adds at the highest resolution. see MemoryFootprint for what is counted.
+ */
+juce::String getFootprintReport()
+{
+    // on the heap, as a host creates it
+    auto processorOnHeap = std::make_unique<EqualizerAudioProcessor>();
+    auto& processor = *processorOnHeap;
+    processor.setRateAndBufferSizeDetails (Benchmark::SAMPLE_RATE, BLOCK_SIZE);
+    processor.prepareToPlay (Benchmark::SAMPLE_RATE, BLOCK_SIZE);
+
+    auto footprint = processor.getMemoryFootprint();
+
+    // the threads of the producers are never started: they start once the editor gives them bounds
+    PathProducer<juce::AudioBuffer<float>> leftPathProducer { Benchmark::SAMPLE_RATE, processor.spectrumAnalyzerFifoLeft };
+    PathProducer<juce::AudioBuffer<float>> rightPathProducer { Benchmark::SAMPLE_RATE, processor.spectrumAnalyzerFifoRight };
+    leftPathProducer.changeOrder (FFTOrder::order8192);
+    rightPathProducer.changeOrder (FFTOrder::order8192);
+    footprint.add ("editor analyzer, 8192 points", leftPathProducer.getMemoryFootprint() + rightPathProducer.getMemoryFootprint());
+
+    juce::String report;
+    report << "memory footprint, stereo, " << Benchmark::SAMPLE_RATE << " Hz, blocks of " << BLOCK_SIZE << " samples\n"
+           << footprint.toString();
+
+    processor.releaseResources();
+    return report;
+}
@@ -0,0 +1,110 @@
+#include "Benchmark.h"
+#include "utils/ChainHelpers.h"
+#include "utils/FusedBlockPipeline.h"
+#include "utils/LaneChain.h"
+#include <JuceHeader.h>
+
+namespace
+{
+/*
+ the separate stages make 11 passes over every host block: input gain, input meter
+ (peak and RMS of each channel, 4 scans), filters, output gain, output meter (4 scans).
+ the fused pipeline makes a single one.
+ */
+std::vector<Benchmark::Result> runHostBlockSize (int hostBlockSize)
+{
+    juce::Random random { 42 };
+    juce::AudioBuffer<float> buffer { 2, Benchmark::NUM_SAMPLES };
+    Benchmark::fillWithNoise (buffer, random);
+
+    ChainHelpers::MonoChain leftChain, rightChain;
+    Benchmark::configurePeaks (leftChain, 3.0f);
+    Benchmark::configurePeaks (rightChain, -3.0f);
+
+    juce::dsp::ProcessSpec spec { Benchmark::SAMPLE_RATE, static_cast<juce::uint32> (hostBlockSize), 2 };
+    juce::dsp::Gain<float> inputGain, outputGain;
+    inputGain.prepare (spec);
+    outputGain.prepare (spec);
+    inputGain.setGainDecibels (-3.0f);
+    outputGain.setGainDecibels (3.0f);
+
+    StereoChain separateChain, fusedChain;
+    separateChain.reset();
+    fusedChain.reset();
+
+    FusedBlockPipeline::Meter<float> inputMeter, outputMeter;
+    FusedBlockPipeline::Stages<float> stages { inputGain, outputGain, inputMeter, outputMeter };
+
+    // what the processor did before: juce's peak and RMS, one scan each per channel, 4 per meter
+    MeterValues meterValues;
+    auto meter = [&meterValues] (const juce::dsp::AudioBlock<float>& block)
+    {
+        std::array<float*, 2> channels { block.getChannelPointer (0), block.getChannelPointer (1) };
+        auto numSamples = static_cast<int> (block.getNumSamples());
+        juce::AudioBuffer<float> view { channels.data(), 2, numSamples };
+
+        meterValues.leftPeakDb.setGain (view.getMagnitude (0, 0, numSamples));
+        meterValues.rightPeakDb.setGain (view.getMagnitude (1, 0, numSamples));
+        meterValues.leftRmsDb.setGain (view.getRMSLevel (0, 0, numSamples));
+        meterValues.rightRmsDb.setGain (view.getRMSLevel (1, 0, numSamples));
+    };
+
+    auto sizeName = juce::String (hostBlockSize) + " samples";
+    std::vector<Benchmark::Result> results;
+
+    results.push_back (Benchmark::run ("Separate stages (11 passes), " + sizeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (
+                                               buffer,
+                                               hostBlockSize,
+                                               [&] (juce::dsp::AudioBlock<float> hostBlock)
+                                               {
+                                                   inputGain.process (juce::dsp::ProcessContextReplacing<float> (hostBlock));
+                                                   meter (hostBlock);
+                                                   separateChain.update ({ &leftChain, &rightChain });
+                                                   separateChain.process (hostBlock);
+                                                   outputGain.process (juce::dsp::ProcessContextReplacing<float> (hostBlock));
+                                                   meter (hostBlock);
+                                               });
+                                       }));
+
+    results.push_back (Benchmark::run ("Fused pipeline (1 pass), " + sizeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (
+                                               buffer,
+                                               hostBlockSize,
+                                               [&] (juce::dsp::AudioBlock<float> hostBlock)
+                                               {
+                                                   fusedChain.update ({ &leftChain, &rightChain });
+                                                   FusedBlockPipeline::process<FusedBlockPipeline::INPUT_GAIN | FusedBlockPipeline::OUTPUT_GAIN> (
+                                                       hostBlock,
+                                                       stages,
+                                                       [&] (juce::dsp::AudioBlock<float>& chunk) { fusedChain.process (chunk); },
+                                                       [] (const juce::dsp::AudioBlock<float>&) {},
+                                                       [] (const juce::dsp::AudioBlock<float>&) {});
+                                                   meterValues = outputMeter.getMeterValues();
+                                               });
+                                       }));
+
+    return results;
+}
+} // namespace
+
+std::vector<Benchmark::Result> runFusedPipelineBenchmarks()
+{
+    std::vector<Benchmark::Result> results;
+
+    for (auto hostBlockSize : { 32, 128, 1024 })
+    {
+        auto sizeResults = runHostBlockSize (hostBlockSize);
+        results.insert (results.end(), sizeResults.begin(), sizeResults.end());
+    }
+
+    return results;
+}
@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include <JuceHeader.h>
+
+std::vector<Benchmark::Result> runStereoChainBenchmarks();
+std::vector<Benchmark::Result> runCoefficientsBenchmarks();
+std::vector<Benchmark::Result> runFusedPipelineBenchmarks();
+std::vector<Benchmark::Result> runProcessorBenchmarks();
+std::vector<Benchmark::Result> runFifoBenchmarks();
+juce::String getFootprintReport();
+
+/*
+ --json=<file> also writes every result to 'file', see Benchmark::toJson()
+ --footprint only prints the memory an instance holds, see getFootprintReport()
+ */
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList arguments (argc, argv);
+
+    if (arguments.containsOption ("--footprint"))
+    {
+        std::cout << getFootprintReport();
+        return 0;
+    }
+
+    std::vector<Benchmark::Result> results;
+    for (auto runBenchmarks : { runStereoChainBenchmarks, runCoefficientsBenchmarks, runFusedPipelineBenchmarks, runProcessorBenchmarks, runFifoBenchmarks })
+    {
+        auto suiteResults = runBenchmarks();
+        Benchmark::print (suiteResults);
+        results.insert (results.end(), suiteResults.begin(), suiteResults.end());
+    }
+
+    if (arguments.containsOption ("--json"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--json"));
+        if (! file.replaceWithText (Benchmark::toJson (results)))
+        {
+            std::cerr << "can't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+#include "utils/ChainHelpers.h"
+#include "utils/FilterParam.h"
+#include <JuceHeader.h>
+#include <thread>
+
+namespace
+{
+const int FILTER_TIMEOUT_MS = 30000;
+
+// the engine, the mode, the active bands and the host block size of a run, the other parameters are the defaults
+struct Configuration
+{
+    FilterEngine engine = FilterEngine::BIQUAD;
+    EqMode mode = EqMode::STEREO;
+    int numActiveBands = 8;
+    // 0 is 6 dB/oct, 7 is 48 dB/oct
+    int slope = 3;
+    int blockSize = 512;
+    // the peak bands sweep their frequency and gain for the whole run
+    bool automated = false;
+};
+
+const juce::StringArray MODE_NAMES { "Stereo", "Dual Mono", "Mid/Side" };
+const juce::StringArray ENGINE_NAMES { "Biquad", "SVF", "Parallel", "Linear Phase" };
+
+// the bands a run activates, by number of active bands
+std::vector<ChainPositions> getActiveBands (int numActiveBands)
+{
+    switch (numActiveBands)
+    {
+        case 0:
+            return {};
+        case 1:
+            return { ChainPositions::PEAK2 };
+        case 2:
+            return { ChainPositions::LOWCUT, ChainPositions::HIGHCUT };
+        case 4:
+            return { ChainPositions::LOWCUT, ChainPositions::PEAK1, ChainPositions::PEAK3, ChainPositions::HIGHCUT };
+        default:
+            jassert (numActiveBands == 8);
+            return { ChainPositions::LOWCUT, ChainPositions::LOWSHELF, ChainPositions::PEAK1,     ChainPositions::PEAK2,
+                     ChainPositions::PEAK3,  ChainPositions::PEAK4,    ChainPositions::HIGHSHELF, ChainPositions::HIGHCUT };
+    }
+}
+
+const std::array<float, 8> BAND_FREQUENCIES { 80.0f, 150.0f, 300.0f, 1000.0f, 3000.0f, 6000.0f, 10000.0f, 16000.0f };
+
+void setParameter (EqualizerAudioProcessor& processor, const juce::String& name, float value)
+{
+    auto* parameter = processor.apvts.getParameter (name);
+    jassert (parameter != nullptr);
+    parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+}
+
+void setBandParameter (EqualizerAudioProcessor& processor, ChainPositions band, Channel channel, FilterInfo::FilterParam param, float value)
+{
+    setParameter (processor, FilterInfo::getParameterName (static_cast<int> (band), channel, param), value);
+}
+
+bool isCutBand (ChainPositions band)
+{
+    return band == ChainPositions::LOWCUT || band == ChainPositions::HIGHCUT;
+}
+
+void configure (EqualizerAudioProcessor& processor, const Configuration& configuration)
+{
+    setParameter (processor, "filter_engine", static_cast<float> (configuration.engine));
+    setParameter (processor, "eq_mode", static_cast<float> (configuration.mode));
+
+    auto activeBands = getActiveBands (configuration.numActiveBands);
+    for (size_t index = 0; index < BAND_FREQUENCIES.size(); ++index)
+    {
+        auto band = static_cast<ChainPositions> (index);
+        auto isActive = std::find (activeBands.begin(), activeBands.end(), band) != activeBands.end();
+
+        for (auto channel : { Channel::LEFT, Channel::RIGHT })
+        {
+            // the two channels differ, so that dual mono and mid/side run two different chains
+            auto sign = channel == Channel::LEFT ? 1.0f : -1.0f;
+
+            setBandParameter (processor, band, channel, FilterInfo::FilterParam::BYPASS, isActive ? 0.0f : 1.0f);
+            setBandParameter (processor, band, channel, FilterInfo::FilterParam::FREQUENCY, BAND_FREQUENCIES[index]);
+            if (isCutBand (band))
+            {
+                setBandParameter (processor, band, channel, FilterInfo::FilterParam::SLOPE, static_cast<float> (configuration.slope));
+            }
+            else
+            {
+                setBandParameter (processor, band, channel, FilterInfo::FilterParam::GAIN, sign * 4.0f);
+            }
+        }
+    }
+}
+
+// one step of the automation per host block, a slow sweep as a host would send it
+void automate (EqualizerAudioProcessor& processor, double phase)
+{
+    const std::array<ChainPositions, 4> peaks { ChainPositions::PEAK1, ChainPositions::PEAK2, ChainPositions::PEAK3, ChainPositions::PEAK4 };
+    for (auto band : peaks)
+    {
+        auto index = static_cast<size_t> (band);
+        auto offset = static_cast<float> (std::sin (phase + static_cast<double> (index)));
+        for (auto channel : { Channel::LEFT, Channel::RIGHT })
+        {
+            setBandParameter (processor, band, channel, FilterInfo::FilterParam::FREQUENCY, BAND_FREQUENCIES[index] * std::pow (2.0f, offset));
+            setBandParameter (processor, band, channel, FilterInfo::FilterParam::GAIN, 6.0f * offset);
+        }
+    }
+}
+
+juce::String getName (const Configuration& configuration)
+{
+    juce::String name;
+    name << "processBlock " << ENGINE_NAMES[static_cast<int> (configuration.engine)] << ", " << MODE_NAMES[static_cast<int> (configuration.mode)] << ", " << configuration.numActiveBands << " bands, "
+         << (configuration.slope + 1) * 6 << " dB/oct, block " << configuration.blockSize;
+    if (configuration.automated)
+    {
+        name << ", automated";
+    }
+    return name;
+}
+
+Benchmark::Result run (const Configuration& configuration)
+{
+    juce::Random random { 42 };
+    juce::AudioBuffer<float> input { 2, Benchmark::NUM_SAMPLES };
+    Benchmark::fillWithNoise (input, random);
+
+    // on the heap and on the message thread, as a host creates it
+    auto processorOnHeap = std::make_unique<EqualizerAudioProcessor>();
+    auto& processor = *processorOnHeap;
+    // prepareToPlay() initialises the chains with the parameters
+    configure (processor, configuration);
+    processor.setRateAndBufferSizeDetails (Benchmark::SAMPLE_RATE, configuration.blockSize);
+    processor.prepareToPlay (Benchmark::SAMPLE_RATE, configuration.blockSize);
+
+    // the linear phase runs measure the final FIRs, not their loading and crossfade
+    auto filtersReady = processor.waitForFilters (FILTER_TIMEOUT_MS);
+    jassert (filtersReady);
+    juce::ignoreUnused (filtersReady);
+
+    // every host block starts from the same input, the runs don't feed each other
+    juce::AudioBuffer<float> hostBuffer { 2, configuration.blockSize };
+    juce::MidiBuffer midiMessages;
+    const auto phaseIncrement = juce::MathConstants<double>::twoPi * 0.5 * configuration.blockSize / Benchmark::SAMPLE_RATE;
+    double phase = 0.0;
+
+    auto process = [&]
+    {
+        for (int offset = 0; offset < Benchmark::NUM_SAMPLES; offset += configuration.blockSize)
+        {
+            auto numSamples = juce::jmin (configuration.blockSize, Benchmark::NUM_SAMPLES - offset);
+            if (configuration.automated)
+            {
+                automate (processor, phase);
+                phase += phaseIncrement;
+            }
+
+            juce::AudioBuffer<float> block { hostBuffer.getArrayOfWritePointers(), 2, 0, numSamples };
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                block.copyFrom (channel, 0, input, channel, offset, numSamples);
+            }
+            processor.processBlock (block, midiMessages);
+        }
+    };
+
+    // only processBlock runs on another thread than the message thread, as it does in a host
+    Benchmark::Result result;
+    std::thread audioThread ([&]
+                             { result = Benchmark::run (getName (configuration), Benchmark::NUM_RUNS, Benchmark::NUM_SAMPLES, process); });
+    audioThread.join();
+
+    result.configuration.set ("benchmark", "processBlock");
+    result.configuration.set ("engine", ENGINE_NAMES[static_cast<int> (configuration.engine)]);
+    result.configuration.set ("mode", MODE_NAMES[static_cast<int> (configuration.mode)]);
+    result.configuration.set ("activeBands", configuration.numActiveBands);
+    result.configuration.set ("cutSlopeDbPerOctave", (configuration.slope + 1) * 6);
+    result.configuration.set ("blockSize", configuration.blockSize);
+    result.configuration.set ("automated", configuration.automated);
+
+    processor.releaseResources();
+    return result;
+}
+
+/*
+ one dimension at a time around the default configuration: biquad engine, stereo,
+ all 8 bands, 24 dB/oct cuts, blocks of 512 samples, no automation.
+ */
+std::vector<Configuration> getConfigurations()
+{
+    std::vector<Configuration> configurations;
+
+    // the other engines at the default configuration and at the smallest and largest blocks
+    for (auto engine : { FilterEngine::SVF, FilterEngine::PARALLEL, FilterEngine::LINEAR_PHASE })
+    {
+        for (auto blockSize : { 16, Configuration().blockSize, 4096 })
+        {
+            Configuration configuration;
+            configuration.engine = engine;
+            configuration.blockSize = blockSize;
+            configurations.push_back (configuration);
+        }
+    }
+
+    for (auto mode : { EqMode::STEREO, EqMode::DUAL_MONO, EqMode::MID_SIDE })
+    {
+        for (auto numActiveBands : { 0, 1, 4, 8 })
+        {
+            for (auto automated : { false, true })
+            {
+                if (automated && numActiveBands != 8)
+                {
+                    continue;
+                }
+
+                Configuration configuration;
+                configuration.mode = mode;
+                configuration.numActiveBands = numActiveBands;
+                configuration.automated = automated;
+                configurations.push_back (configuration);
+            }
+        }
+    }
+
+    // the cuts alone, so that their slope is what changes the cost
+    for (int slope = 0; slope < 8; ++slope)
+    {
+        Configuration configuration;
+        configuration.numActiveBands = 2;
+        configuration.slope = slope;
+        configurations.push_back (configuration);
+    }
+
+    for (int blockSize = 16; blockSize <= 4096; blockSize *= 2)
+    {
+        // measured above
+        if (blockSize == Configuration().blockSize)
+        {
+            continue;
+        }
+
+        for (auto automated : { false, true })
+        {
+            Configuration configuration;
+            configuration.blockSize = blockSize;
+            configuration.automated = automated;
+            configurations.push_back (configuration);
+        }
+    }
+
+    return configurations;
+}
+
+bool isSameRunWithBiquads (const Configuration& configuration, const Configuration& other)
+{
+    return other.engine == FilterEngine::BIQUAD && other.mode == configuration.mode
+           && other.numActiveBands == configuration.numActiveBands && other.slope == configuration.slope
+           && other.blockSize == configuration.blockSize && other.automated == configuration.automated;
+}
+
+/*
+ each run of another engine against the biquad run of the same configuration:
+ the linear phase engine is meant to cost about as much per instance as the IIR engines.
+ */
+void compareWithBiquads (const std::vector<Configuration>& configurations, std::vector<Benchmark::Result>& results)
+{
+    for (size_t i = 0; i < configurations.size(); ++i)
+    {
+        if (configurations[i].engine == FilterEngine::BIQUAD)
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < configurations.size(); ++j)
+        {
+            if (isSameRunWithBiquads (configurations[i], configurations[j]) && results[j].nsPerSample > 0.0)
+            {
+                auto ratio = results[i].nsPerSample / results[j].nsPerSample;
+                results[i].name << " (" << juce::String (ratio, 2) << "x biquad)";
+                results[i].configuration.set ("relativeToBiquad", ratio);
+            }
+        }
+    }
+}
+} // namespace
+
+/*
+ the whole processor, as a host runs it: parameters, trims, meters, analyzer fifos and filters.
+ the processor is created, configured and prepared on the message thread and processBlock
+ runs on another thread, so the filters take the same paths as they do in a host: the
+ initial coefficients are computed in prepareToPlay(), the updates on the worker pool.
+ */
+std::vector<Benchmark::Result> runProcessorBenchmarks()
+{
+    std::vector<Benchmark::Result> results;
+
+    auto configurations = getConfigurations();
+    for (const auto& configuration : configurations)
+    {
+        results.push_back (run (configuration));
+    }
+    compareWithBiquads (configurations, results);
+
+    return results;
+}
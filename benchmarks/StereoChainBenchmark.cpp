@@ -0,0 +1,203 @@
+#include "Benchmark.h"
+#include "utils/ChainHelpers.h"
+#include "utils/LaneChain.h"
+#include "utils/MultichannelChain.h"
+#include <JuceHeader.h>
+
+namespace
+{
+const int SUB_BLOCK_SIZE = 32;
+// a 7.1 bed
+const int NUM_SURROUND_CHANNELS = 8;
+
+/*
+ the baseline: the sections of a chain in series on a single channel, transposed direct
+ form II, one section over the whole sub-block at a time, as the links filtered before
+ the lanes took over.
+ */
+struct ScalarCascade
+{
+    // 4 sections for each cut filter, 1 for each parametric band
+    static const size_t MAX_SECTIONS = 14;
+
+    void setSections (const ChainHelpers::MonoChain& chain)
+    {
+        numSections = 0;
+        append (chain.get<0>());
+        append (chain.get<1>());
+        append (chain.get<2>());
+        append (chain.get<3>());
+        append (chain.get<4>());
+        append (chain.get<5>());
+        append (chain.get<6>());
+        append (chain.get<7>());
+    }
+
+    void process (float* samples, size_t numSamples) noexcept
+    {
+        for (size_t i = 0; i < numSections; ++i)
+        {
+            const auto& section = sections[i];
+            auto& state = states[i];
+
+            for (size_t n = 0; n < numSamples; ++n)
+            {
+                auto x = samples[n];
+                auto y = section.b0 * x + state.s1;
+                state.s1 = section.b1 * x - section.a1 * y + state.s2;
+                state.s2 = section.b2 * x - section.a2 * y;
+                samples[n] = y;
+            }
+        }
+    }
+
+private:
+    template <typename Link>
+    void append (const Link& link)
+    {
+        typename Link::Sections linkSections;
+        auto count = link.getSections (linkSections);
+        std::copy_n (linkSections.begin(), count, sections.begin() + static_cast<std::ptrdiff_t> (numSections));
+        numSections += count;
+    }
+
+    struct State
+    {
+        float s1 = 0.0f;
+        float s2 = 0.0f;
+    };
+
+    std::array<BiquadSection<float>, MAX_SECTIONS> sections {};
+    std::array<State, MAX_SECTIONS> states {};
+    size_t numSections = 0;
+};
+
+std::vector<Benchmark::Result> runSlope (int slope)
+{
+    juce::Random random { 42 };
+    juce::AudioBuffer<float> buffer { 2, Benchmark::NUM_SAMPLES };
+    Benchmark::fillWithNoise (buffer, random);
+
+    ChainHelpers::MonoChain leftChain, rightChain;
+    Benchmark::configureChain (leftChain, slope, 6.0f);
+    Benchmark::configureChain (rightChain, slope, -6.0f);
+
+    ScalarCascade leftCascade, rightCascade;
+    leftCascade.setSections (leftChain);
+    rightCascade.setSections (rightChain);
+
+    StereoChain stereoChain;
+    stereoChain.reset();
+
+    StereoChain parallelStereoChain;
+    parallelStereoChain.setParallelFormEnabled (true);
+    parallelStereoChain.reset();
+
+    juce::AudioBuffer<double> doubleBuffer { 2, Benchmark::NUM_SAMPLES };
+    doubleBuffer.makeCopyOf (buffer);
+    LaneChain<2, double> doubleStereoChain;
+    doubleStereoChain.reset();
+
+    juce::AudioBuffer<float> surroundBuffer { NUM_SURROUND_CHANNELS, Benchmark::NUM_SAMPLES };
+    Benchmark::fillWithNoise (surroundBuffer, random);
+    MultichannelChain<float> surroundChain;
+    surroundChain.prepare (SUB_BLOCK_SIZE);
+    MultichannelChain<float>::Chains surroundChains {};
+    for (size_t channel = 0; channel < static_cast<size_t> (NUM_SURROUND_CHANNELS); ++channel)
+    {
+        surroundChains[channel] = channel % 2 == 0 ? &leftChain : &rightChain;
+    }
+
+    auto slopeName = juce::String (6 + slope * 6) + " dB/Oct";
+
+    std::vector<Benchmark::Result> results;
+
+    results.push_back (Benchmark::run ("Scalar cascade pair, " + slopeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (
+                                               buffer,
+                                               SUB_BLOCK_SIZE,
+                                               [&] (juce::dsp::AudioBlock<float> subBlock)
+                                               {
+                                                   leftCascade.process (subBlock.getChannelPointer (0), subBlock.getNumSamples());
+                                                   rightCascade.process (subBlock.getChannelPointer (1), subBlock.getNumSamples());
+                                               });
+                                       }));
+
+    results.push_back (Benchmark::run ("StereoChain, " + slopeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (buffer,
+                                                                       SUB_BLOCK_SIZE,
+                                                                       [&] (juce::dsp::AudioBlock<float> subBlock)
+                                                                       {
+                                                                           stereoChain.update ({ &leftChain, &rightChain });
+                                                                           stereoChain.process (subBlock);
+                                                                       });
+                                       }));
+
+    results.push_back (Benchmark::run ("StereoChain (parallel form), " + slopeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (buffer,
+                                                                       SUB_BLOCK_SIZE,
+                                                                       [&] (juce::dsp::AudioBlock<float> subBlock)
+                                                                       {
+                                                                           parallelStereoChain.update ({ &leftChain, &rightChain });
+                                                                           parallelStereoChain.process (subBlock);
+                                                                       });
+                                       }));
+
+    results.push_back (Benchmark::run ("StereoChain (double), " + slopeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (doubleBuffer,
+                                                                       SUB_BLOCK_SIZE,
+                                                                       [&] (juce::dsp::AudioBlock<double> subBlock)
+                                                                       {
+                                                                           doubleStereoChain.update ({ &leftChain, &rightChain });
+                                                                           doubleStereoChain.process (subBlock);
+                                                                       });
+                                       }));
+
+    // per pair of channels, like the stereo runs
+    results.push_back (Benchmark::run ("MultichannelChain (7.1), " + slopeName,
+                                       Benchmark::NUM_RUNS,
+                                       Benchmark::NUM_SAMPLES * NUM_SURROUND_CHANNELS / 2,
+                                       [&]
+                                       {
+                                           Benchmark::processInBlocks (
+                                               surroundBuffer,
+                                               SUB_BLOCK_SIZE,
+                                               [&] (juce::dsp::AudioBlock<float> subBlock)
+                                               {
+                                                   surroundChain.update (surroundChains, static_cast<size_t> (NUM_SURROUND_CHANNELS));
+                                                   surroundChain.process (subBlock);
+                                               });
+                                       }));
+
+    return results;
+}
+} // namespace
+
+std::vector<Benchmark::Result> runStereoChainBenchmarks()
+{
+    std::vector<Benchmark::Result> results;
+
+    for (auto slope : { 1, 3, 7 })
+    {
+        auto slopeResults = runSlope (slope);
+        results.insert (results.end(), slopeResults.begin(), slopeResults.end());
+    }
+
+    return results;
+}